@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+#include "Traversal.h"
+
+namespace graph
+{
+	// Answers many (from, to) queries at once on an immutable graph. Queries are grouped by
+	// source and each group is served by one Dijkstra run that stops once all of the group's
+	// targets are settled; groups are spread over the pool and every worker reuses its own
+	// TraversalWorkspace. Results come back in input order with findPath semantics: the path from
+	// "from" to "to" inclusive and its cost, or an empty path and the maximum W.
+	// Non-negative weights
+	template <typename W, typename V>
+	std::vector<std::pair<std::vector<V>, W>> BatchShortestPaths(const CSRGraph<W, V>& g, const std::vector<std::pair<V, V>>& queries, parallel::ThreadPool& pool)
+	{
+		constexpr W		   unreachable = std::numeric_limits<W>::max();
+		constexpr uint32_t missing = std::numeric_limits<uint32_t>::max();
+
+		std::vector<std::pair<std::vector<V>, W>> res(queries.size(), std::make_pair(std::vector<V>(), unreachable));
+
+		auto lookup = [&](V node) {
+			auto it = g.index.find(node);
+			return it == g.index.end() ? missing : it->second;
+		};
+
+		// (source, target, query) sorted by source, then split into per-source groups
+		std::vector<std::array<uint32_t, 3>> order;
+		order.reserve(queries.size());
+		for (uint32_t q = 0; q < queries.size(); ++q)
+		{
+			uint32_t from = lookup(queries[q].first), to = lookup(queries[q].second);
+			if (queries[q].first == queries[q].second)
+			{
+				res[q] = std::make_pair(std::vector<V>(1, queries[q].first), W(0));
+			}
+			else if (from != missing && to != missing)
+			{
+				order.push_back({ from, to, q });
+			}
+		}
+		parallel::parallelSort(order, [](const auto& a, const auto& b) { return a < b; }, pool);
+		std::vector<size_t> groups;
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			if (i == 0 || order[i][0] != order[i - 1][0])
+			{
+				groups.push_back(i);
+			}
+		}
+		groups.push_back(order.size());
+
+		std::vector<TraversalWorkspace<W>> workspaces(pool.getThreadsCount(), TraversalWorkspace<W>(g.getNodesCount()));
+
+		pool.parallelFor(groups.size() - 1, [&](size_t begin, size_t end, size_t worker) {
+			auto& ws = workspaces[worker];
+			for (size_t group = begin; group < end; ++group)
+			{
+				size_t	 first = groups[group], last = groups[group + 1];
+				uint32_t source = order[first][0];
+
+				// targets still to settle, duplicates within the group are counted once
+				size_t remaining = 0;
+				for (size_t i = first; i < last; ++i)
+				{
+					if (i == first || order[i][1] != order[i - 1][1])
+					{
+						++remaining;
+					}
+				}
+				detail::dijkstraSearch(source, g, ws, [&](uint32_t u) {
+					auto target = std::lower_bound(order.begin() + first, order.begin() + last, u, [](const auto& a, uint32_t b) { return a[1] < b; });
+					return target != order.begin() + last && (*target)[1] == u && --remaining == 0;
+				});
+
+				for (size_t i = first; i < last; ++i)
+				{
+					uint32_t to = order[i][1];
+					if (!ws.isDone(to))
+					{
+						continue;
+					}
+					auto& [path, cost] = res[order[i][2]];
+					cost = ws.getDist(to);
+					for (uint32_t u = to; u != source; u = ws.getParent(u))
+					{
+						path.push_back(g.ids[u]);
+					}
+					path.push_back(g.ids[source]);
+					std::reverse(path.begin(), path.end());
+				}
+			}
+		}, 1);
+		return res;
+	}
+
+	template <typename W, typename V>
+	std::vector<std::pair<std::vector<V>, W>> BatchShortestPaths(const WGraph<W, V>& g, const std::vector<std::pair<V, V>>& queries, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return BatchShortestPaths(toCSR(g), queries, pool);
+	}
+} // namespace graph
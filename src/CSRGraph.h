@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+namespace graph
+{
+	// Compressed sparse row snapshot of a graph over dense indices 0..n-1.
+	// Neighbours of node u are targets[offsets[u]..offsets[u + 1]), ids maps a dense index
+	// back to the original node and index maps it forward
+	template <typename W = unsigned int, typename V = int>
+	struct CSRGraph
+	{
+		using Weight = W;
+		using Vertex = V;
+
+		size_t getNodesCount() const { return ids.size(); }
+
+		size_t getEdgesCount() const { return targets.size(); }
+
+		// Unweighted graphs keep weights empty, every edge then weighs 1
+		W getWeight(size_t edge) const { return weights.empty() ? W(1) : weights[edge]; }
+
+		// f(target, weight) for every outgoing edge of u
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			for (size_t e = offsets[u]; e < offsets[u + 1]; ++e)
+			{
+				f(targets[e], getWeight(e));
+			}
+		}
+
+		uint32_t getIndex(V node) const
+		{
+			auto it = index.find(node);
+			if (it == index.end())
+			{
+				throw std::out_of_range("Node is not in the graph");
+			}
+			return it->second;
+		}
+
+		std::vector<size_t>				offsets;
+		std::vector<uint32_t>			targets;
+		std::vector<W>					weights;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	// Structure-of-arrays edge list over the same dense indices, for edge-centric kernels
+	template <typename W = unsigned int, typename V = int>
+	struct EdgeList
+	{
+		size_t getNodesCount() const { return ids.size(); }
+
+		size_t getEdgesCount() const { return sources.size(); }
+
+		std::vector<uint32_t>			sources;
+		std::vector<uint32_t>			targets;
+		std::vector<W>					weights;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	// Counting sort of (sources[i], targets[i], weights[i]) by source into CSR arrays.
+	// weights may be empty for an unweighted graph
+	template <typename W = unsigned int, typename V = int>
+	CSRGraph<W, V> buildCSR(std::vector<V> ids, const std::vector<uint32_t>& sources, const std::vector<uint32_t>& targets, const std::vector<W>& weights)
+	{
+		CSRGraph<W, V> csr;
+		size_t		   n = ids.size();
+		csr.offsets.assign(n + 1, 0);
+		for (uint32_t source : sources)
+		{
+			++csr.offsets[source + 1];
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			csr.offsets[i + 1] += csr.offsets[i];
+		}
+
+		std::vector<size_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1);
+		csr.targets.resize(sources.size());
+		csr.weights.resize(weights.size());
+		for (size_t e = 0; e < sources.size(); ++e)
+		{
+			size_t slot = cursor[sources[e]]++;
+			csr.targets[slot] = targets[e];
+			if (!weights.empty())
+			{
+				csr.weights[slot] = weights[e];
+			}
+		}
+
+		csr.ids = std::move(ids);
+		csr.index.reserve(n);
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			csr.index.emplace(csr.ids[i], i);
+		}
+		return csr;
+	}
+
+	namespace detail
+	{
+		template <typename Graph, typename W, typename V, typename WeightOf>
+		CSRGraph<W, V> toCSR(const Graph& g, bool reversed, bool weighted, WeightOf weight_of)
+		{
+			std::vector<V>				  ids(g.nodes.begin(), g.nodes.end());
+			std::unordered_map<V, uint32_t> index;
+			index.reserve(ids.size());
+			for (uint32_t i = 0; i < ids.size(); ++i)
+			{
+				index.emplace(ids[i], i);
+			}
+
+			const auto&			  edges = reversed ? g.edges_from : g.edges_to;
+			std::vector<uint32_t> sources, targets;
+			std::vector<W>		  weights;
+			sources.reserve(edges.size());
+			targets.reserve(edges.size());
+			if (weighted)
+			{
+				weights.reserve(edges.size());
+			}
+			for (auto& [from, edge] : edges)
+			{
+				sources.push_back(index[from]);
+				targets.push_back(index[Graph::getEdgeDirection(edge)]);
+				if (weighted)
+				{
+					weights.push_back(weight_of(edge));
+				}
+			}
+			return buildCSR<W, V>(std::move(ids), sources, targets, weights);
+		}
+	} // namespace detail
+
+	// Snapshot of edges_to (or edges_from when reversed), dense indices follow the order of nodes
+	template <typename W, typename V>
+	CSRGraph<W, V> toCSR(const WGraph<W, V>& g, bool reversed = false)
+	{
+		return detail::toCSR<WGraph<W, V>, W, V>(g, reversed, true, [](auto& edge) { return WGraph<W, V>::getEdgeWeight(edge); });
+	}
+
+	template <typename V>
+	CSRGraph<unsigned int, V> toCSR(const UGraph<V>& g, bool reversed = false)
+	{
+		return detail::toCSR<UGraph<V>, unsigned int, V>(g, reversed, false, [](auto&) { return 1u; });
+	}
+
+	// Adds every edge in the opposite direction too, for algorithms on undirected connectivity
+	template <typename W, typename V>
+	CSRGraph<W, V> symmetrize(const CSRGraph<W, V>& csr)
+	{
+		size_t				  m = csr.getEdgesCount();
+		std::vector<uint32_t> sources(2 * m), targets(2 * m);
+		std::vector<W>		  weights(csr.weights.empty() ? 0 : 2 * m);
+		for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+		{
+			for (size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+			{
+				sources[e] = targets[m + e] = u;
+				targets[e] = sources[m + e] = csr.targets[e];
+				if (!weights.empty())
+				{
+					weights[e] = weights[m + e] = csr.weights[e];
+				}
+			}
+		}
+		return buildCSR<W, V>(csr.ids, sources, targets, weights);
+	}
+
+	// Same nodes with every edge reversed: out-neighbours become in-neighbours, for pull-style
+	// algorithms that gather over incoming edges
+	template <typename W, typename V>
+	CSRGraph<W, V> transpose(const CSRGraph<W, V>& csr)
+	{
+		std::vector<uint32_t> sources(csr.getEdgesCount());
+		for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+		{
+			std::fill(sources.begin() + csr.offsets[u], sources.begin() + csr.offsets[u + 1], u);
+		}
+		return buildCSR<W, V>(csr.ids, csr.targets, sources, csr.weights);
+	}
+
+	template <typename W, typename V>
+	EdgeList<W, V> toEdgeList(const CSRGraph<W, V>& csr)
+	{
+		EdgeList<W, V> list;
+		list.sources.reserve(csr.getEdgesCount());
+		for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+		{
+			list.sources.insert(list.sources.end(), csr.offsets[u + 1] - csr.offsets[u], u);
+		}
+		list.targets = csr.targets;
+		list.weights.resize(csr.getEdgesCount());
+		for (size_t e = 0; e < csr.getEdgesCount(); ++e)
+		{
+			list.weights[e] = csr.getWeight(e);
+		}
+		list.ids = csr.ids;
+		list.index = csr.index;
+		return list;
+	}
+} // namespace graph
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+namespace graph
+{
+	// Per-node scores over dense indices, with the convergence history of iterative methods
+	template <typename V = int>
+	struct CentralityScores
+	{
+		double getScore(V node) const { return scores[index.at(node)]; }
+
+		// One line per iteration: residual and wall time
+		void printReport(std::ostream& out) const
+		{
+			double total = 0;
+			for (size_t i = 0; i < residuals.size(); ++i)
+			{
+				total += iteration_ms[i];
+				out << "iteration " << i + 1 << ": residual " << residuals[i] << ", " << iteration_ms[i] << " ms" << std::endl;
+			}
+			out << residuals.size() << " iterations, " << total << " ms" << std::endl;
+		}
+
+		std::vector<double>				scores;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+		std::vector<double>				residuals;	  // L1 change of the scores per iteration
+		std::vector<double>				iteration_ms; // wall time per iteration
+	};
+
+	struct PageRankOptions
+	{
+		double damping = 0.85;
+		double tolerance = 1e-9; // stops once the L1 change of an iteration drops below it
+		size_t max_iterations = 100;
+		bool   weighted = false; // split a node's rank by edge weight instead of evenly
+	};
+
+	struct BetweennessOptions
+	{
+		size_t	 samples = 0; // number of random sources, 0 runs from every node (exact)
+		unsigned seed = 1;
+		bool	 normalized = false; // divide by (n - 1)(n - 2), the number of ordered pairs excluding the node
+	};
+
+	namespace detail
+	{
+		// Per-worker partial sums on separate cache lines
+		struct alignas(64) PartialSum
+		{
+			double value = 0;
+		};
+
+		template <typename W, typename V>
+		CentralityScores<V> makeScores(const CSRGraph<W, V>& g, std::vector<double> scores)
+		{
+			CentralityScores<V> res;
+			res.scores = std::move(scores);
+			res.ids = g.ids;
+			res.index = g.index;
+			return res;
+		}
+
+		// Pull-based power iteration over incoming edges: every node gathers the rank its
+		// in-neighbours pass on, so each iteration writes every score exactly once and needs no
+		// atomics. Contributions (rank / out-weight) are precomputed in a flat loop the
+		// compiler vectorizes, the gather then streams the in-edge arrays. Teleport and the
+		// rank of dangling nodes are redistributed according to teleport, which sums to 1
+		template <typename W, typename V>
+		CentralityScores<V> pageRank(const CSRGraph<W, V>& g, const std::vector<double>& teleport, parallel::ThreadPool& pool, const PageRankOptions& options)
+		{
+			size_t		   n = g.getNodesCount();
+			CSRGraph<W, V> in = transpose(g);
+			bool		   weighted = options.weighted && !g.weights.empty();
+
+			std::vector<double> inv_out(n, 0.0);
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				for (size_t u = begin; u < end; ++u)
+				{
+					double out = 0;
+					for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+					{
+						out += weighted ? double(g.weights[e]) : 1.0;
+					}
+					inv_out[u] = out > 0 ? 1.0 / out : 0.0;
+				}
+			});
+
+			std::vector<double>		rank = teleport, next(n), contrib(n);
+			std::vector<PartialSum> partial(pool.getThreadsCount());
+
+			auto reduce = [&partial]() {
+				double sum = 0;
+				for (auto& p : partial)
+				{
+					sum += p.value;
+					p.value = 0;
+				}
+				return sum;
+			};
+
+			CentralityScores<V> res = makeScores(g, {});
+			double				damping = options.damping;
+			for (size_t iteration = 0; iteration < options.max_iterations; ++iteration)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				pool.parallelFor(n, [&](size_t begin, size_t end, size_t worker) {
+					const double* r = rank.data();
+					const double* inv = inv_out.data();
+					double*		  c = contrib.data();
+					double		  dangling = 0;
+					for (size_t u = begin; u < end; ++u)
+					{
+						c[u] = r[u] * inv[u];
+						dangling += inv[u] == 0.0 ? r[u] : 0.0;
+					}
+					partial[worker].value += dangling;
+				});
+				double dangling = reduce();
+
+				pool.parallelFor(n, [&](size_t begin, size_t end, size_t worker) {
+					const double* c = contrib.data();
+					double		  residual = 0;
+					for (size_t v = begin; v < end; ++v)
+					{
+						double sum = 0;
+						for (size_t e = in.offsets[v], last = in.offsets[v + 1]; e < last; ++e)
+						{
+							sum += weighted ? c[in.targets[e]] * double(in.weights[e]) : c[in.targets[e]];
+						}
+						next[v] = (1.0 - damping + damping * dangling) * teleport[v] + damping * sum;
+						residual += std::abs(next[v] - rank[v]);
+					}
+					partial[worker].value += residual;
+				});
+				rank.swap(next);
+
+				res.residuals.push_back(reduce());
+				res.iteration_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				if (res.residuals.back() < options.tolerance)
+				{
+					break;
+				}
+			}
+
+			res.scores = std::move(rank);
+			return res;
+		}
+	} // namespace detail
+
+	// Scores sum to 1; a node's rank is split evenly over its out-edges (by weight if
+	// options.weighted) and dangling nodes spread theirs over the whole graph
+	template <typename W, typename V>
+	CentralityScores<V> PageRank(const CSRGraph<W, V>& g, parallel::ThreadPool& pool, const PageRankOptions& options = PageRankOptions())
+	{
+		size_t n = g.getNodesCount();
+		return detail::pageRank(g, std::vector<double>(n, n ? 1.0 / n : 0.0), pool, options);
+	}
+
+	// Random walks restart at one of sources (uniformly) instead of anywhere in the graph,
+	// which ranks nodes by proximity to the sources
+	template <typename W, typename V>
+	CentralityScores<V> PersonalizedPageRank(const CSRGraph<W, V>& g, const std::vector<uint32_t>& sources, parallel::ThreadPool& pool, const PageRankOptions& options = PageRankOptions())
+	{
+		if (sources.empty())
+		{
+			throw std::invalid_argument("Personalized PageRank needs at least one source");
+		}
+		std::vector<double> teleport(g.getNodesCount(), 0.0);
+		for (uint32_t source : sources)
+		{
+			teleport[source] += 1.0 / sources.size();
+		}
+		return detail::pageRank(g, teleport, pool, options);
+	}
+
+	// Sum of outgoing edge weights (out-degree for unweighted graphs); pass transpose(g) for
+	// the incoming side
+	template <typename W, typename V>
+	CentralityScores<V> DegreeCentrality(const CSRGraph<W, V>& g, parallel::ThreadPool& pool)
+	{
+		std::vector<double> degree(g.getNodesCount(), 0.0);
+		pool.parallelFor(g.getNodesCount(), [&](size_t begin, size_t end, size_t) {
+			for (size_t u = begin; u < end; ++u)
+			{
+				double sum = 0;
+				for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+				{
+					sum += double(g.getWeight(e));
+				}
+				degree[u] = sum;
+			}
+		});
+		return detail::makeScores(g, std::move(degree));
+	}
+
+	// Brandes' betweenness: one single-source search per source (BFS for unweighted graphs,
+	// Dijkstra otherwise) counts shortest paths, then dependencies are accumulated in reverse
+	// visit order over successors, so no predecessor lists are kept. Sources run in parallel,
+	// each worker owns its search arrays and score accumulator, which are summed at the end.
+	// With options.samples = k < n, k sources are drawn without replacement and the scores
+	// are scaled by n / k, an unbiased estimate. Edges are directed: on a symmetric graph every
+	// pair is counted in both directions, halve the scores for the undirected convention.
+	// Weights must be positive
+	template <typename W, typename V>
+	CentralityScores<V> Betweenness(const CSRGraph<W, V>& g, parallel::ThreadPool& pool, const BetweennessOptions& options = BetweennessOptions())
+	{
+		constexpr W unreachable = std::numeric_limits<W>::max();
+		size_t		n = g.getNodesCount();
+
+		std::vector<uint32_t> sources(n);
+		std::iota(sources.begin(), sources.end(), 0u);
+		if (options.samples && options.samples < n)
+		{
+			std::mt19937 rng(options.seed);
+			std::shuffle(sources.begin(), sources.end(), rng);
+			sources.resize(options.samples);
+		}
+
+		struct Worker
+		{
+			std::vector<W>						dist;
+			std::vector<double>					sigma;
+			std::vector<double>					delta;
+			std::vector<double>					scores;
+			std::vector<uint32_t>				order;
+			std::vector<std::pair<W, uint32_t>> heap;
+		};
+		std::vector<Worker> workers(pool.getThreadsCount());
+
+		pool.parallelFor(sources.size(), [&](size_t begin, size_t end, size_t worker) {
+			Worker& w = workers[worker];
+			if (w.dist.empty())
+			{
+				w.dist.assign(n, unreachable);
+				w.sigma.assign(n, 0.0);
+				w.delta.assign(n, 0.0);
+				w.scores.assign(n, 0.0);
+			}
+			std::greater<std::pair<W, uint32_t>> later;
+			for (size_t i = begin; i < end; ++i)
+			{
+				uint32_t source = sources[i];
+				w.order.clear();
+				w.dist[source] = 0;
+				w.sigma[source] = 1;
+
+				if (g.weights.empty())
+				{
+					w.order.push_back(source);
+					for (size_t head = 0; head < w.order.size(); ++head)
+					{
+						uint32_t u = w.order[head];
+						g.forEachNeighbour(u, [&](uint32_t v, W) {
+							if (w.dist[v] == unreachable)
+							{
+								w.dist[v] = w.dist[u] + 1;
+								w.order.push_back(v);
+							}
+							if (w.dist[v] == w.dist[u] + 1)
+							{
+								w.sigma[v] += w.sigma[u];
+							}
+						});
+					}
+				}
+				else
+				{
+					// a node's sigma is final once it is settled, since all its predecessors are closer
+					w.heap.emplace_back(W(0), source);
+					while (!w.heap.empty())
+					{
+						std::pop_heap(w.heap.begin(), w.heap.end(), later);
+						auto [d, u] = w.heap.back();
+						w.heap.pop_back();
+						if (d > w.dist[u])
+						{
+							continue;
+						}
+						w.order.push_back(u);
+						g.forEachNeighbour(u, [&](uint32_t v, W weight) {
+							if (d + weight < w.dist[v])
+							{
+								w.dist[v] = d + weight;
+								w.sigma[v] = w.sigma[u];
+								w.heap.emplace_back(w.dist[v], v);
+								std::push_heap(w.heap.begin(), w.heap.end(), later);
+							}
+							else if (d + weight == w.dist[v])
+							{
+								w.sigma[v] += w.sigma[u];
+							}
+						});
+					}
+				}
+
+				for (auto it = w.order.rbegin(); it != w.order.rend(); ++it)
+				{
+					uint32_t u = *it;
+					double	 dependency = 0;
+					g.forEachNeighbour(u, [&](uint32_t v, W weight) {
+						if (w.dist[v] != unreachable && w.dist[u] + weight == w.dist[v])
+						{
+							dependency += w.sigma[u] / w.sigma[v] * (1.0 + w.delta[v]);
+						}
+					});
+					w.delta[u] = dependency;
+					if (u != source)
+					{
+						w.scores[u] += dependency;
+					}
+				}
+
+				for (uint32_t u : w.order)
+				{
+					w.dist[u] = unreachable;
+					w.sigma[u] = w.delta[u] = 0.0;
+				}
+			}
+		}, 1);
+
+		double scale = sources.empty() ? 0.0 : double(n) / sources.size();
+		if (options.normalized && n > 2)
+		{
+			scale /= double(n - 1) * double(n - 2);
+		}
+		std::vector<double> scores(n, 0.0);
+		pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+			for (size_t u = begin; u < end; ++u)
+			{
+				for (const Worker& w : workers)
+				{
+					scores[u] += w.scores.empty() ? 0.0 : w.scores[u];
+				}
+				scores[u] *= scale;
+			}
+		});
+		return detail::makeScores(g, std::move(scores));
+	}
+
+	template <typename W, typename V>
+	CentralityScores<V> PageRank(const WGraph<W, V>& g, const PageRankOptions& options = PageRankOptions(), size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return PageRank(toCSR(g), pool, options);
+	}
+
+	template <typename W, typename V>
+	CentralityScores<V> PersonalizedPageRank(const WGraph<W, V>& g, const std::vector<V>& sources, const PageRankOptions& options = PageRankOptions(), size_t threads = 0)
+	{
+		parallel::ThreadPool  pool(threads);
+		auto				  csr = toCSR(g);
+		std::vector<uint32_t> dense;
+		for (V source : sources)
+		{
+			dense.push_back(csr.getIndex(source));
+		}
+		return PersonalizedPageRank(csr, dense, pool, options);
+	}
+
+	template <typename W, typename V>
+	CentralityScores<V> DegreeCentrality(const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return DegreeCentrality(toCSR(g), pool);
+	}
+
+	template <typename W, typename V>
+	CentralityScores<V> Betweenness(const WGraph<W, V>& g, const BetweennessOptions& options = BetweennessOptions(), size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return Betweenness(toCSR(g), pool, options);
+	}
+
+	template <typename V>
+	CentralityScores<V> Betweenness(const UGraph<V>& g, const BetweennessOptions& options = BetweennessOptions(), size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return Betweenness(toCSR(g), pool, options);
+	}
+} // namespace graph
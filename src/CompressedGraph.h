@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "CSRGraph.h"
+
+namespace graph
+{
+	namespace detail
+	{
+		inline void writeVarint(std::vector<uint8_t>& out, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		inline uint64_t readVarint(const uint8_t*& p)
+		{
+			uint64_t value = *p++;
+			if (value < 0x80)
+			{
+				return value;
+			}
+			value &= 0x7F;
+			for (unsigned shift = 7;; shift += 7)
+			{
+				uint64_t byte = *p++;
+				value |= (byte & 0x7F) << shift;
+				if (byte < 0x80)
+				{
+					return value;
+				}
+			}
+		}
+
+		inline uint64_t zigzag(int64_t value)
+		{
+			return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+		}
+
+		inline int64_t unzigzag(uint64_t value)
+		{
+			return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+		}
+	} // namespace detail
+
+	// Read-only adjacency with every neighbour list sorted and gap-encoded as varints:
+	// the first target relative to the node itself (zigzag), each following one relative to
+	// its predecessor. Integral weights follow their target as (zigzag) varints, floating
+	// point weights are stored raw. Lists are decoded on the fly by forEachNeighbour, so the
+	// generic traversals (BFSDistances, DFSOrder, DijkstraDistances) run on it directly.
+	// With a locality-friendly numbering (see GraphReorder.h) most gaps fit in one byte
+	template <typename W = unsigned int, typename V = int>
+	class CompressedGraph
+	{
+	public:
+		using Weight = W;
+		using Vertex = V;
+
+		explicit CompressedGraph(const CSRGraph<W, V>& g)
+			: ids(g.ids)
+			, weighted(!g.weights.empty())
+			, edges(g.getEdgesCount())
+		{
+			size_t n = g.getNodesCount();
+			id_order.resize(n);
+			std::iota(id_order.begin(), id_order.end(), 0u);
+			std::sort(id_order.begin(), id_order.end(), [&](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+
+			block_offsets.reserve(n / block_size + 2);
+			offsets.reserve(n + 1);
+			std::vector<std::pair<uint32_t, W>> adjacency;
+			for (uint32_t u = 0; u < n; ++u)
+			{
+				addOffset(u);
+				adjacency.clear();
+				g.forEachNeighbour(u, [&](uint32_t v, W w) { adjacency.emplace_back(v, w); });
+				std::sort(adjacency.begin(), adjacency.end(), [](auto& a, auto& b) { return a.first < b.first; });
+
+				int64_t previous = u;
+				for (size_t i = 0; i < adjacency.size(); ++i)
+				{
+					int64_t target = adjacency[i].first;
+					detail::writeVarint(data, i == 0 ? detail::zigzag(target - previous) : static_cast<uint64_t>(target - previous));
+					previous = target;
+					if (weighted)
+					{
+						writeWeight(adjacency[i].second);
+					}
+				}
+			}
+			addOffset(static_cast<uint32_t>(n));
+			data.shrink_to_fit();
+		}
+
+		size_t getNodesCount() const { return ids.size(); }
+
+		size_t getEdgesCount() const { return edges; }
+
+		// Bytes used by the adjacency encoding and its offsets
+		size_t getAdjacencyBytesCount() const { return data.size() + offsets.size() * sizeof(uint32_t) + block_offsets.size() * sizeof(uint64_t); }
+
+		// Everything the graph holds: adjacency plus ids and the sorted id order for lookups
+		size_t getBytesCount() const { return getAdjacencyBytesCount() + ids.size() * sizeof(V) + id_order.size() * sizeof(uint32_t); }
+
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			const uint8_t* p = data.data() + getOffset(u);
+			const uint8_t* end = data.data() + getOffset(u + 1);
+			int64_t		   target = u;
+			for (bool first = true; p < end; first = false)
+			{
+				uint64_t gap = detail::readVarint(p);
+				target += first ? detail::unzigzag(gap) : static_cast<int64_t>(gap);
+				f(static_cast<uint32_t>(target), weighted ? readWeight(p) : W(1));
+			}
+		}
+
+		// Binary search over the ids in sorted order, no hash map is kept
+		uint32_t getIndex(V node) const
+		{
+			auto it = std::lower_bound(id_order.begin(), id_order.end(), node, [&](uint32_t idx, const V& key) { return ids[idx] < key; });
+			if (it == id_order.end() || ids[*it] != node)
+			{
+				throw std::out_of_range("Node is not in the graph");
+			}
+			return *it;
+		}
+
+		std::vector<V> ids;
+
+	private:
+		// Node offsets are 32-bit and relative to a 64-bit base shared by block_size nodes
+		static constexpr size_t block_size = 1024;
+
+		void addOffset(uint32_t u)
+		{
+			if (u % block_size == 0)
+			{
+				block_offsets.push_back(data.size());
+			}
+			offsets.push_back(static_cast<uint32_t>(data.size() - block_offsets.back()));
+		}
+
+		size_t getOffset(uint32_t u) const
+		{
+			return block_offsets[u / block_size] + offsets[u];
+		}
+
+		void writeWeight(W weight)
+		{
+			if constexpr (std::is_floating_point_v<W>)
+			{
+				const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&weight);
+				data.insert(data.end(), bytes, bytes + sizeof(W));
+			}
+			else if constexpr (std::is_signed_v<W>)
+			{
+				detail::writeVarint(data, detail::zigzag(static_cast<int64_t>(weight)));
+			}
+			else
+			{
+				detail::writeVarint(data, static_cast<uint64_t>(weight));
+			}
+		}
+
+		static W readWeight(const uint8_t*& p)
+		{
+			if constexpr (std::is_floating_point_v<W>)
+			{
+				W weight;
+				std::memcpy(&weight, p, sizeof(W));
+				p += sizeof(W);
+				return weight;
+			}
+			else if constexpr (std::is_signed_v<W>)
+			{
+				return static_cast<W>(detail::unzigzag(detail::readVarint(p)));
+			}
+			else
+			{
+				return static_cast<W>(detail::readVarint(p));
+			}
+		}
+
+		bool				  weighted;
+		size_t				  edges;
+		std::vector<uint64_t> block_offsets;
+		std::vector<uint32_t> offsets;
+		std::vector<uint8_t>  data;
+		std::vector<uint32_t> id_order; // dense indices sorted by id
+	};
+} // namespace graph
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+namespace graph
+{
+	// Disjoint sets over 0..n-1 with path halving and union by rank
+	class UnionFind
+	{
+	public:
+		explicit UnionFind(size_t n)
+			: parents(n)
+			, ranks(n, 0)
+			, sets(n)
+		{
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				parents[i] = i;
+			}
+		}
+
+		uint32_t find(uint32_t x)
+		{
+			while (parents[x] != x)
+			{
+				parents[x] = parents[parents[x]];
+				x = parents[x];
+			}
+			return x;
+		}
+
+		// Returns false if a and b were already in the same set
+		bool unite(uint32_t a, uint32_t b)
+		{
+			a = find(a);
+			b = find(b);
+			if (a == b)
+			{
+				return false;
+			}
+			if (ranks[a] < ranks[b])
+			{
+				std::swap(a, b);
+			}
+			parents[b] = a;
+			if (ranks[a] == ranks[b])
+			{
+				++ranks[a];
+			}
+			--sets;
+			return true;
+		}
+
+		bool connected(uint32_t a, uint32_t b) { return find(a) == find(b); }
+
+		size_t getSetsCount() const { return sets; }
+
+		size_t getSize() const { return parents.size(); }
+
+	private:
+		std::vector<uint32_t> parents;
+		std::vector<uint8_t>  ranks;
+		size_t				  sets;
+	};
+
+	// Component label of every dense index (0..k-1, numbered by smallest member) and sizes
+	template <typename V = int>
+	struct Components
+	{
+		size_t getComponentsCount() const { return sizes.size(); }
+
+		uint32_t getLabel(V node) const { return labels[index.at(node)]; }
+
+		// component size -> number of components of that size
+		std::map<size_t, size_t> getSizeHistogram() const
+		{
+			std::map<size_t, size_t> histogram;
+			for (size_t size : sizes)
+			{
+				++histogram[size];
+			}
+			return histogram;
+		}
+
+		std::vector<uint32_t>			labels;
+		std::vector<size_t>				sizes;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	namespace detail
+	{
+		// Lock-free hooking of the higher root under the lower one (Shiloach-Vishkin style)
+		inline void link(uint32_t u, uint32_t v, std::vector<std::atomic<uint32_t>>& comp)
+		{
+			uint32_t p1 = comp[u].load(std::memory_order_relaxed);
+			uint32_t p2 = comp[v].load(std::memory_order_relaxed);
+			while (p1 != p2)
+			{
+				uint32_t high = std::max(p1, p2), low = std::min(p1, p2);
+				uint32_t p_high = comp[high].load(std::memory_order_relaxed);
+				if (p_high == low)
+				{
+					break;
+				}
+				if (p_high == high && comp[high].compare_exchange_strong(p_high, low, std::memory_order_relaxed))
+				{
+					break;
+				}
+				p1 = comp[comp[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+				p2 = comp[low].load(std::memory_order_relaxed);
+			}
+		}
+
+		inline void compress(std::vector<std::atomic<uint32_t>>& comp, parallel::ThreadPool& pool)
+		{
+			pool.parallelFor(comp.size(), [&](size_t begin, size_t end, size_t) {
+				for (size_t v = begin; v < end; ++v)
+				{
+					uint32_t parent = comp[v].load(std::memory_order_relaxed);
+					while (parent != comp[parent].load(std::memory_order_relaxed))
+					{
+						parent = comp[parent].load(std::memory_order_relaxed);
+					}
+					comp[v].store(parent, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		template <typename V>
+		Components<V> finishComponents(std::vector<std::atomic<uint32_t>>& comp, const std::vector<V>& ids, const std::unordered_map<V, uint32_t>& index)
+		{
+			Components<V>		  res;
+			std::vector<uint32_t> dense(comp.size(), std::numeric_limits<uint32_t>::max());
+			res.labels.resize(comp.size());
+			for (size_t v = 0; v < comp.size(); ++v)
+			{
+				uint32_t root = comp[v].load(std::memory_order_relaxed);
+				if (dense[root] == std::numeric_limits<uint32_t>::max())
+				{
+					dense[root] = static_cast<uint32_t>(res.sizes.size());
+					res.sizes.push_back(0);
+				}
+				res.labels[v] = dense[root];
+				++res.sizes[dense[root]];
+			}
+			res.ids = ids;
+			res.index = index;
+			return res;
+		}
+
+		inline std::vector<std::atomic<uint32_t>> makeComponents(size_t n)
+		{
+			std::vector<std::atomic<uint32_t>> comp(n);
+			for (uint32_t v = 0; v < n; ++v)
+			{
+				comp[v].store(v, std::memory_order_relaxed);
+			}
+			return comp;
+		}
+	} // namespace detail
+
+	// Connected components straight from an edge array: all edges are hooked in parallel,
+	// then every node is pointed at its root. Edge direction is ignored
+	template <typename W, typename V>
+	Components<V> ConnectedComponents(const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		auto comp = detail::makeComponents(edges.getNodesCount());
+		pool.parallelFor(edges.getEdgesCount(), [&](size_t begin, size_t end, size_t) {
+			for (size_t e = begin; e < end; ++e)
+			{
+				detail::link(edges.sources[e], edges.targets[e], comp);
+			}
+		});
+		detail::compress(comp, pool);
+		return detail::finishComponents(comp, edges.ids, edges.index);
+	}
+
+	// Afforest (Sutton et al.): a few neighbour rounds link most of the graph, then the most
+	// frequent component is found by sampling and its nodes skip the remaining edges.
+	// g must be symmetric, see symmetrize
+	template <typename W, typename V>
+	Components<V> ConnectedComponents(const CSRGraph<W, V>& g, parallel::ThreadPool& pool, size_t neighbour_rounds = 2)
+	{
+		size_t n = g.getNodesCount();
+		auto   comp = detail::makeComponents(n);
+
+		for (size_t r = 0; r < neighbour_rounds; ++r)
+		{
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				for (size_t u = begin; u < end; ++u)
+				{
+					if (g.offsets[u] + r < g.offsets[u + 1])
+					{
+						detail::link(static_cast<uint32_t>(u), g.targets[g.offsets[u] + r], comp);
+					}
+				}
+			});
+			detail::compress(comp, pool);
+		}
+
+		uint32_t largest = 0;
+		if (n > 0)
+		{
+			std::mt19937							rng(27491095);
+			std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(n - 1));
+			std::unordered_map<uint32_t, size_t>	counts;
+			size_t									best = 0;
+			for (size_t i = 0; i < 1024; ++i)
+			{
+				uint32_t root = comp[pick(rng)].load(std::memory_order_relaxed);
+				if (++counts[root] > best)
+				{
+					best = counts[root];
+					largest = root;
+				}
+			}
+		}
+
+		pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+			for (size_t u = begin; u < end; ++u)
+			{
+				if (comp[u].load(std::memory_order_relaxed) == largest)
+				{
+					continue;
+				}
+				for (size_t e = g.offsets[u] + neighbour_rounds; e < g.offsets[u + 1]; ++e)
+				{
+					detail::link(static_cast<uint32_t>(u), g.targets[e], comp);
+				}
+			}
+		});
+		detail::compress(comp, pool);
+		return detail::finishComponents(comp, g.ids, g.index);
+	}
+
+	// Weakly connected components of a graph, edge direction is ignored
+	template <typename W, typename V>
+	Components<V> ConnectedComponents(const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return ConnectedComponents(symmetrize(toCSR(g)), pool);
+	}
+
+	template <typename V>
+	Components<V> ConnectedComponents(const UGraph<V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return ConnectedComponents(symmetrize(toCSR(g)), pool);
+	}
+
+	// Strongly connected components with the condensation DAG. Components are numbered in
+	// topological order of the condensation; dag holds one edge per ordered pair of adjacent components,
+	// weighted with the cheapest original edge between them
+	template <typename W = unsigned int, typename V = int>
+	struct StronglyConnectedComponents
+	{
+		size_t getComponentsCount() const { return dag.getNodesCount(); }
+
+		uint32_t getLabel(V node) const { return labels[index.at(node)]; }
+
+		std::vector<uint32_t>			labels;
+		CSRGraph<W, uint32_t>			dag;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	// Iterative Tarjan: the DFS keeps (node, next edge) frames on an explicit stack, so depth
+	// is bounded by memory rather than by the call stack
+	template <typename W, typename V>
+	StronglyConnectedComponents<W, V> TarjanSCC(const CSRGraph<W, V>& g)
+	{
+		constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+		size_t									   n = g.getNodesCount();
+		std::vector<uint32_t>					   order(n, none), low(n, 0), labels(n, none), stack;
+		std::vector<std::pair<uint32_t, size_t>>   frames;
+		uint32_t								   next_order = 0, components = 0;
+
+		for (uint32_t root = 0; root < n; ++root)
+		{
+			if (order[root] != none)
+			{
+				continue;
+			}
+			frames.emplace_back(root, g.offsets[root]);
+			order[root] = low[root] = next_order++;
+			stack.push_back(root);
+
+			while (!frames.empty())
+			{
+				auto& [u, edge] = frames.back();
+				if (edge < g.offsets[u + 1])
+				{
+					uint32_t v = g.targets[edge++];
+					if (order[v] == none)
+					{
+						order[v] = low[v] = next_order++;
+						stack.push_back(v);
+						frames.emplace_back(v, g.offsets[v]);
+					}
+					else if (labels[v] == none)
+					{
+						low[u] = std::min(low[u], order[v]);
+					}
+					continue;
+				}
+
+				uint32_t finished = u;
+				frames.pop_back();
+				if (!frames.empty())
+				{
+					uint32_t parent = frames.back().first;
+					low[parent] = std::min(low[parent], low[finished]);
+				}
+				if (low[finished] == order[finished])
+				{
+					uint32_t member;
+					do
+					{
+						member = stack.back();
+						stack.pop_back();
+						labels[member] = components;
+					} while (member != finished);
+					++components;
+				}
+			}
+		}
+
+		// Tarjan emits components in reverse topological order
+		for (uint32_t& label : labels)
+		{
+			label = components - 1 - label;
+		}
+
+		std::unordered_map<uint64_t, size_t> cheapest;
+		std::vector<uint32_t>				 sources, targets;
+		std::vector<W>						 weights;
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+			{
+				uint32_t from = labels[u], to = labels[g.targets[e]];
+				if (from == to)
+				{
+					continue;
+				}
+				auto [it, inserted] = cheapest.emplace((uint64_t(from) << 32) | to, sources.size());
+				if (inserted)
+				{
+					sources.push_back(from);
+					targets.push_back(to);
+					weights.push_back(g.getWeight(e));
+				}
+				else
+				{
+					weights[it->second] = std::min(weights[it->second], g.getWeight(e));
+				}
+			}
+		}
+
+		std::vector<uint32_t> dag_ids(components);
+		for (uint32_t c = 0; c < components; ++c)
+		{
+			dag_ids[c] = c;
+		}
+
+		StronglyConnectedComponents<W, V> res;
+		res.labels = std::move(labels);
+		res.dag = buildCSR<W, uint32_t>(std::move(dag_ids), sources, targets, weights);
+		res.ids = g.ids;
+		res.index = g.index;
+		return res;
+	}
+
+	template <typename W, typename V>
+	StronglyConnectedComponents<W, V> TarjanSCC(const WGraph<W, V>& g)
+	{
+		return TarjanSCC(toCSR(g));
+	}
+
+	template <typename V>
+	StronglyConnectedComponents<unsigned int, V> TarjanSCC(const UGraph<V>& g)
+	{
+		return TarjanSCC(toCSR(g));
+	}
+
+	// Kahn's algorithm over dense indices, throws if the graph has a cycle
+	template <typename W, typename V>
+	std::vector<uint32_t> TopologicalSort(const CSRGraph<W, V>& g)
+	{
+		size_t				  n = g.getNodesCount();
+		std::vector<uint32_t> in_degree(n, 0), order;
+		order.reserve(n);
+		for (uint32_t target : g.targets)
+		{
+			++in_degree[target];
+		}
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			if (in_degree[u] == 0)
+			{
+				order.push_back(u);
+			}
+		}
+		for (size_t head = 0; head < order.size(); ++head)
+		{
+			uint32_t u = order[head];
+			for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+			{
+				if (--in_degree[g.targets[e]] == 0)
+				{
+					order.push_back(g.targets[e]);
+				}
+			}
+		}
+		if (order.size() != n)
+		{
+			throw std::runtime_error("Graph contains a cycle");
+		}
+		return order;
+	}
+
+	template <typename W, typename V>
+	std::vector<V> TopologicalSort(const WGraph<W, V>& g)
+	{
+		auto		   csr = toCSR(g);
+		std::vector<V> res;
+		for (uint32_t u : TopologicalSort(csr))
+		{
+			res.push_back(csr.ids[u]);
+		}
+		return res;
+	}
+
+	template <typename V>
+	std::vector<V> TopologicalSort(const UGraph<V>& g)
+	{
+		auto		   csr = toCSR(g);
+		std::vector<V> res;
+		for (uint32_t u : TopologicalSort(csr))
+		{
+			res.push_back(csr.ids[u]);
+		}
+		return res;
+	}
+
+	// Single-source shortest paths on a DAG in one sweep over a topological order,
+	// linear time and correct for negative weights
+	template <typename W, typename V>
+	std::vector<W> DAGShortestPaths(uint32_t from, const CSRGraph<W, V>& dag, const std::vector<uint32_t>& topological_order)
+	{
+		constexpr W	   inf = std::numeric_limits<W>::max();
+		std::vector<W> dist(dag.getNodesCount(), inf);
+		dist[from] = 0;
+		for (uint32_t u : topological_order)
+		{
+			if (dist[u] == inf)
+			{
+				continue;
+			}
+			for (size_t e = dag.offsets[u]; e < dag.offsets[u + 1]; ++e)
+			{
+				W new_dist = dist[u] + dag.getWeight(e);
+				if (new_dist < dist[dag.targets[e]])
+				{
+					dist[dag.targets[e]] = new_dist;
+				}
+			}
+		}
+		return dist;
+	}
+
+	// The condensation of StronglyConnectedComponents is already numbered topologically
+	template <typename W, typename V>
+	std::vector<W> DAGShortestPaths(uint32_t from, const CSRGraph<W, V>& dag)
+	{
+		std::vector<uint32_t> order(dag.getNodesCount());
+		for (uint32_t u = 0; u < order.size(); ++u)
+		{
+			order[u] = u;
+		}
+		return DAGShortestPaths(from, dag, order);
+	}
+} // namespace graph
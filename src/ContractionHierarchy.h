@@ -0,0 +1,694 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Graph.h"
+
+namespace graph
+{
+	// Contraction hierarchy over a WGraph with non-negative weights.
+	// Nodes are contracted one by one in the order of a lazily updated edge-difference priority,
+	// shortcuts preserve shortest distances among the remaining nodes, and queries only ever
+	// move upwards in the resulting order from both ends
+	template <typename W = unsigned int, typename V = int>
+	class ContractionHierarchy
+	{
+		static constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+		static constexpr W		  inf = std::numeric_limits<W>::max();
+
+		struct Arc
+		{
+			uint32_t target;
+			W		 weight;
+			uint32_t middle; // contracted node the shortcut bypasses, no_node for original edges
+		};
+
+	public:
+		// Tuning knob for witness searches: a search that settles more nodes gives up and the
+		// shortcut is inserted anyway, which keeps the hierarchy correct but slightly larger
+		size_t witness_settle_limit = 500;
+
+		ContractionHierarchy() = default;
+
+		explicit ContractionHierarchy(const WGraph<W, V>& g, size_t settle_limit = 500)
+			: witness_settle_limit(settle_limit)
+		{
+			build(g);
+		}
+
+		// Scratch state for repeated queries, resetting between queries is proportional to the
+		// search space rather than to the graph size. One Query per thread
+		class Query
+		{
+		public:
+			explicit Query(const ContractionHierarchy& ch)
+				: ch(ch)
+			{
+				for (auto& side : sides)
+				{
+					side.dist.assign(ch.ids.size(), inf);
+					side.parent_arc.assign(ch.ids.size(), no_node);
+				}
+			}
+
+			// Returns the unpacked path and its length, empty path and maximum W if unreachable
+			std::pair<std::vector<V>, W> findPath(V from, V to)
+			{
+				uint32_t meeting = search(from, to);
+				if (meeting == no_node)
+				{
+					return std::make_pair(std::vector<V>(), inf);
+				}
+
+				std::vector<uint32_t> up_chain;
+				for (uint32_t node = meeting; sides[0].parent_arc[node] != no_node;)
+				{
+					up_chain.push_back(sides[0].parent_arc[node]);
+					node = ch.arc_source_up[sides[0].parent_arc[node]];
+				}
+
+				std::vector<V> path(1, from);
+				for (auto it = up_chain.rbegin(); it != up_chain.rend(); ++it)
+				{
+					ch.unpackUp(*it, path);
+				}
+				for (uint32_t node = meeting; sides[1].parent_arc[node] != no_node;)
+				{
+					uint32_t arc = sides[1].parent_arc[node];
+					ch.unpackDown(arc, path);
+					node = ch.arc_owner_down[arc];
+				}
+				return std::make_pair(std::move(path), best);
+			}
+
+			W distance(V from, V to)
+			{
+				return search(from, to) == no_node ? inf : best;
+			}
+
+		private:
+			struct Side
+			{
+				std::vector<W>		  dist;
+				std::vector<uint32_t> parent_arc;
+				std::vector<uint32_t> touched;
+			};
+
+			using QueueItem = std::pair<W, uint32_t>;
+			using Heap = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+			uint32_t search(V from, V to)
+			{
+				for (auto& side : sides)
+				{
+					for (uint32_t node : side.touched)
+					{
+						side.dist[node] = inf;
+						side.parent_arc[node] = no_node;
+					}
+					side.touched.clear();
+				}
+				best = inf;
+
+				auto from_it = ch.index.find(from);
+				auto to_it = ch.index.find(to);
+				if (from_it == ch.index.end() || to_it == ch.index.end())
+				{
+					return no_node;
+				}
+
+				Heap					   heaps[2];
+				const std::vector<size_t>* offsets[2] = { &ch.up_offsets, &ch.down_offsets };
+				const std::vector<Arc>*	   arcs[2] = { &ch.up_arcs, &ch.down_arcs };
+				uint32_t				   starts[2] = { from_it->second, to_it->second };
+				uint32_t				   meeting = no_node;
+
+				for (int s = 0; s < 2; ++s)
+				{
+					sides[s].dist[starts[s]] = 0;
+					sides[s].touched.push_back(starts[s]);
+					heaps[s].push(std::make_pair(W(0), starts[s]));
+				}
+
+				// the backward search walks down arcs reversed, i.e. again upwards in the order
+				while (!heaps[0].empty() || !heaps[1].empty())
+				{
+					for (int s = 0; s < 2; ++s)
+					{
+						if (heaps[s].empty())
+						{
+							continue;
+						}
+						auto [d, node] = heaps[s].top();
+						heaps[s].pop();
+						if (d >= best)
+						{
+							heaps[s] = Heap();
+							continue;
+						}
+						if (d > sides[s].dist[node])
+						{
+							continue;
+						}
+
+						W other = sides[1 - s].dist[node];
+						if (other != inf && d + other < best)
+						{
+							best = d + other;
+							meeting = node;
+						}
+
+						for (size_t a = (*offsets[s])[node]; a < (*offsets[s])[node + 1]; ++a)
+						{
+							const Arc& arc = (*arcs[s])[a];
+							W		   new_dist = d + arc.weight;
+							if (new_dist < sides[s].dist[arc.target])
+							{
+								if (sides[s].dist[arc.target] == inf)
+								{
+									sides[s].touched.push_back(arc.target);
+								}
+								sides[s].dist[arc.target] = new_dist;
+								sides[s].parent_arc[arc.target] = static_cast<uint32_t>(a);
+								heaps[s].push(std::make_pair(new_dist, arc.target));
+							}
+						}
+					}
+				}
+				return meeting;
+			}
+
+			const ContractionHierarchy& ch;
+			Side						sides[2];
+			W							best = inf;
+		};
+
+		// One-off query, allocates O(V) scratch; use Query for repeated lookups
+		std::pair<std::vector<V>, W> findPath(V from, V to) const
+		{
+			return Query(*this).findPath(from, to);
+		}
+
+		size_t getNodesCount() const { return ids.size(); }
+
+		size_t getShortcutsCount() const
+		{
+			size_t count = 0;
+			for (auto& arc : up_arcs)
+			{
+				count += arc.middle != no_node;
+			}
+			for (auto& arc : down_arcs)
+			{
+				count += arc.middle != no_node;
+			}
+			return count;
+		}
+
+		// Binary layout: magic, version, sizeof(W), sizeof(V), sizeof(size_t), then ids and both
+		// arc arrays
+		void save(std::ostream& out) const
+		{
+			static_assert(std::is_trivially_copyable_v<V> && std::is_trivially_copyable_v<W>, "Serialization needs trivially copyable V and W");
+			writeValue(out, magic);
+			writeValue(out, version);
+			writeValue(out, uint32_t(sizeof(W)));
+			writeValue(out, uint32_t(sizeof(V)));
+			writeValue(out, uint32_t(sizeof(size_t)));
+			writeVector(out, ids);
+			writeVector(out, up_offsets);
+			writeVector(out, up_arcs);
+			writeVector(out, arc_source_up);
+			writeVector(out, down_offsets);
+			writeVector(out, down_arcs);
+			writeVector(out, arc_owner_down);
+			if (!out)
+			{
+				throw std::runtime_error("Failed to write contraction hierarchy");
+			}
+		}
+
+		// Validates everything it reads: no stored length may exceed the bytes left in the stream,
+		// and offsets, arcs and node references must describe a well-formed hierarchy
+		static ContractionHierarchy load(std::istream& in)
+		{
+			ContractionHierarchy ch;
+			if (readValue<uint32_t>(in) != magic || readValue<uint32_t>(in) != version)
+			{
+				throw std::runtime_error("Not a contraction hierarchy file or unsupported version");
+			}
+			if (readValue<uint32_t>(in) != sizeof(W) || readValue<uint32_t>(in) != sizeof(V) || readValue<uint32_t>(in) != sizeof(size_t))
+			{
+				throw std::runtime_error("Contraction hierarchy was saved with different W, V or size_t");
+			}
+			uint64_t remaining = bytesLeft(in);
+			ch.ids = readVector<V>(in, remaining);
+			ch.up_offsets = readVector<size_t>(in, remaining);
+			ch.up_arcs = readVector<Arc>(in, remaining);
+			ch.arc_source_up = readVector<uint32_t>(in, remaining);
+			ch.down_offsets = readVector<size_t>(in, remaining);
+			ch.down_arcs = readVector<Arc>(in, remaining);
+			ch.arc_owner_down = readVector<uint32_t>(in, remaining);
+			if (!in)
+			{
+				throw std::runtime_error("Truncated contraction hierarchy file");
+			}
+			if (!ch.isConsistent())
+			{
+				throw std::runtime_error("Corrupted contraction hierarchy file");
+			}
+			for (uint32_t i = 0; i < ch.ids.size(); ++i)
+			{
+				ch.index.emplace(ch.ids[i], i);
+			}
+			return ch;
+		}
+
+	private:
+		static constexpr uint32_t magic = 0x31484347; // "GCH1"
+		static constexpr uint32_t version = 2;
+
+		// Mutable adjacency used while contracting
+		struct DynArc
+		{
+			uint32_t target;
+			W		 weight;
+			uint32_t middle;
+		};
+
+		struct Builder
+		{
+			std::vector<std::vector<DynArc>> out, in;
+			std::vector<bool>				 contracted;
+			std::vector<uint32_t>			 deleted_neighbours;
+			std::vector<W>					 witness_dist;
+			std::vector<uint32_t>			 witness_touched;
+			size_t							 settle_limit;
+
+			// Local Dijkstra from "source" avoiding "skip" and contracted nodes, stops beyond max_dist
+			void witnessSearch(uint32_t source, uint32_t skip, W max_dist)
+			{
+				for (uint32_t node : witness_touched)
+				{
+					witness_dist[node] = inf;
+				}
+				witness_touched.clear();
+
+				using QueueItem = std::pair<W, uint32_t>;
+				std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> heap;
+				witness_dist[source] = 0;
+				witness_touched.push_back(source);
+				heap.push(std::make_pair(W(0), source));
+
+				size_t settled = 0;
+				while (!heap.empty() && settled < settle_limit)
+				{
+					auto [d, node] = heap.top();
+					heap.pop();
+					if (d > witness_dist[node])
+					{
+						continue;
+					}
+					if (d > max_dist)
+					{
+						break;
+					}
+					++settled;
+					for (const DynArc& arc : out[node])
+					{
+						if (arc.target == skip || contracted[arc.target])
+						{
+							continue;
+						}
+						W new_dist = d + arc.weight;
+						if (new_dist < witness_dist[arc.target])
+						{
+							if (witness_dist[arc.target] == inf)
+							{
+								witness_touched.push_back(arc.target);
+							}
+							witness_dist[arc.target] = new_dist;
+							heap.push(std::make_pair(new_dist, arc.target));
+						}
+					}
+				}
+			}
+
+			// Collects (or only counts when apply == false) the shortcuts needed to contract node
+			int contract(uint32_t node, bool apply)
+			{
+				int added = 0, removed = 0;
+				W	max_out = 0;
+				for (const DynArc& out_arc : out[node])
+				{
+					if (!contracted[out_arc.target])
+					{
+						max_out = std::max(max_out, out_arc.weight);
+					}
+				}
+				for (const DynArc& in_arc : in[node])
+				{
+					if (contracted[in_arc.target])
+					{
+						continue;
+					}
+					++removed;
+
+					witnessSearch(in_arc.target, node, in_arc.weight + max_out);
+
+					for (const DynArc& out_arc : out[node])
+					{
+						if (contracted[out_arc.target] || out_arc.target == in_arc.target)
+						{
+							continue;
+						}
+						W via = in_arc.weight + out_arc.weight;
+						if (witness_dist[out_arc.target] <= via)
+						{
+							continue;
+						}
+						++added;
+						if (apply)
+						{
+							addArc(in_arc.target, out_arc.target, via, node);
+						}
+					}
+				}
+				for (const DynArc& out_arc : out[node])
+				{
+					removed += !contracted[out_arc.target];
+				}
+				return added - removed;
+			}
+
+			void addArc(uint32_t from, uint32_t to, W weight, uint32_t middle)
+			{
+				for (DynArc& arc : out[from])
+				{
+					if (arc.target == to)
+					{
+						if (weight < arc.weight)
+						{
+							arc.weight = weight;
+							arc.middle = middle;
+							for (DynArc& back : in[to])
+							{
+								if (back.target == from)
+								{
+									back.weight = weight;
+									back.middle = middle;
+								}
+							}
+						}
+						return;
+					}
+				}
+				out[from].push_back(DynArc { to, weight, middle });
+				in[to].push_back(DynArc { from, weight, middle });
+			}
+
+			int priority(uint32_t node)
+			{
+				return contract(node, false) + static_cast<int>(deleted_neighbours[node]);
+			}
+		};
+
+		void build(const WGraph<W, V>& g)
+		{
+			for (V node : g.nodes)
+			{
+				index.emplace(node, static_cast<uint32_t>(ids.size()));
+				ids.push_back(node);
+			}
+			size_t n = ids.size();
+
+			Builder b;
+			b.out.resize(n);
+			b.in.resize(n);
+			b.contracted.assign(n, false);
+			b.deleted_neighbours.assign(n, 0);
+			b.witness_dist.assign(n, inf);
+			b.settle_limit = witness_settle_limit;
+			for (auto& [from, edge] : g.edges_to)
+			{
+				uint32_t u = index.at(from), v = index.at(edge.second);
+				if (u != v)
+				{
+					b.addArc(u, v, edge.first, no_node);
+				}
+			}
+
+			// lazy updates: a popped node is re-evaluated and pushed back if it got worse
+			using QueueItem = std::pair<int, uint32_t>;
+			std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> heap;
+			for (uint32_t node = 0; node < n; ++node)
+			{
+				heap.push(std::make_pair(b.priority(node), node));
+			}
+
+			std::vector<uint32_t> rank(n);
+			uint32_t			  next_rank = 0;
+			while (!heap.empty())
+			{
+				uint32_t node = heap.top().second;
+				heap.pop();
+				if (b.contracted[node])
+				{
+					continue;
+				}
+				int current = b.priority(node);
+				if (!heap.empty() && current > heap.top().first)
+				{
+					heap.push(std::make_pair(current, node));
+					continue;
+				}
+
+				b.contract(node, true);
+				b.contracted[node] = true;
+				rank[node] = next_rank++;
+				for (const DynArc& arc : b.out[node])
+				{
+					++b.deleted_neighbours[arc.target];
+				}
+				for (const DynArc& arc : b.in[node])
+				{
+					++b.deleted_neighbours[arc.target];
+				}
+			}
+
+			// every arc ends up either in the upward graph of its source or, reversed,
+			// in the downward graph of its target
+			std::vector<std::vector<Arc>> up(n), down(n);
+			for (uint32_t from = 0; from < n; ++from)
+			{
+				for (const DynArc& arc : b.out[from])
+				{
+					if (rank[arc.target] > rank[from])
+					{
+						up[from].push_back(Arc { arc.target, arc.weight, arc.middle });
+					}
+					else
+					{
+						down[arc.target].push_back(Arc { from, arc.weight, arc.middle });
+					}
+				}
+			}
+			flatten(up, up_offsets, up_arcs);
+			flatten(down, down_offsets, down_arcs);
+			arc_source_up.resize(up_arcs.size());
+			arc_owner_down.resize(down_arcs.size());
+			for (uint32_t node = 0; node < n; ++node)
+			{
+				std::fill(arc_source_up.begin() + up_offsets[node], arc_source_up.begin() + up_offsets[node + 1], node);
+				std::fill(arc_owner_down.begin() + down_offsets[node], arc_owner_down.begin() + down_offsets[node + 1], node);
+			}
+		}
+
+		static void flatten(const std::vector<std::vector<Arc>>& lists, std::vector<size_t>& offsets, std::vector<Arc>& arcs)
+		{
+			offsets.assign(1, 0);
+			for (auto& list : lists)
+			{
+				arcs.insert(arcs.end(), list.begin(), list.end());
+				offsets.push_back(arcs.size());
+			}
+		}
+
+		// Arc lookup by endpoints, both halves of a shortcut hang off its middle node
+		uint32_t findUp(uint32_t from, uint32_t to) const
+		{
+			for (size_t a = up_offsets[from]; a < up_offsets[from + 1]; ++a)
+			{
+				if (up_arcs[a].target == to)
+				{
+					return static_cast<uint32_t>(a);
+				}
+			}
+			throw std::runtime_error("Corrupted contraction hierarchy");
+		}
+
+		uint32_t findDown(uint32_t at, uint32_t from) const
+		{
+			for (size_t a = down_offsets[at]; a < down_offsets[at + 1]; ++a)
+			{
+				if (down_arcs[a].target == from)
+				{
+					return static_cast<uint32_t>(a);
+				}
+			}
+			throw std::runtime_error("Corrupted contraction hierarchy");
+		}
+
+		// Appends the original nodes of an arc (without its source) to path
+		void unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<V>& path) const
+		{
+			std::vector<std::pair<uint32_t, uint32_t>> pending(1, std::make_pair(from, to));
+			std::vector<uint32_t>					   middles(1, middle);
+			while (!pending.empty())
+			{
+				auto [u, w] = pending.back();
+				uint32_t m = middles.back();
+				pending.pop_back();
+				middles.pop_back();
+				if (m == no_node)
+				{
+					path.push_back(ids[w]);
+					continue;
+				}
+				// u -> m is stored reversed at m, m -> w is an upward arc of m; push second half first
+				pending.push_back(std::make_pair(m, w));
+				middles.push_back(up_arcs[findUp(m, w)].middle);
+				pending.push_back(std::make_pair(u, m));
+				middles.push_back(down_arcs[findDown(m, u)].middle);
+			}
+		}
+
+		void unpackUp(uint32_t arc, std::vector<V>& path) const
+		{
+			unpack(arc_source_up[arc], up_arcs[arc].target, up_arcs[arc].middle, path);
+		}
+
+		void unpackDown(uint32_t arc, std::vector<V>& path) const
+		{
+			// a down arc owned by x with target y stands for the original edge y -> x
+			unpack(down_arcs[arc].target, arc_owner_down[arc], down_arcs[arc].middle, path);
+		}
+
+		template <typename T>
+		static void writeValue(std::ostream& out, const T& value)
+		{
+			out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		static void writeVector(std::ostream& out, const std::vector<T>& vec)
+		{
+			writeValue(out, uint64_t(vec.size()));
+			out.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+		}
+
+		template <typename T>
+		static T readValue(std::istream& in)
+		{
+			T value {};
+			in.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return value;
+		}
+
+		// Bytes between the read position and the end of a seekable stream, unbounded otherwise
+		static uint64_t bytesLeft(std::istream& in)
+		{
+			auto position = in.tellg();
+			if (position == std::istream::pos_type(-1) || !in.seekg(0, std::ios::end))
+			{
+				in.clear();
+				return std::numeric_limits<uint64_t>::max();
+			}
+			auto end = in.tellg();
+			in.seekg(position);
+			return static_cast<uint64_t>(end - position);
+		}
+
+		// Rejects lengths larger than what is left, then reads in bounded pieces so a bogus length
+		// on an unseekable stream runs out of data before it can allocate much
+		template <typename T>
+		static std::vector<T> readVector(std::istream& in, uint64_t& remaining)
+		{
+			uint64_t count = readValue<uint64_t>(in);
+			remaining -= std::min<uint64_t>(remaining, sizeof(uint64_t));
+			if (!in || count > remaining / sizeof(T))
+			{
+				throw std::runtime_error("Truncated contraction hierarchy file");
+			}
+			remaining -= count * sizeof(T);
+
+			constexpr size_t piece = std::max<size_t>(1, (size_t(1) << 20) / sizeof(T));
+			std::vector<T>	 vec;
+			while (vec.size() < count && in)
+			{
+				size_t done = vec.size();
+				vec.resize(done + static_cast<size_t>(std::min<uint64_t>(piece, count - done)));
+				in.read(reinterpret_cast<char*>(vec.data() + done), (vec.size() - done) * sizeof(T));
+			}
+			return vec;
+		}
+
+		// Offsets cover their arc arrays and never decrease, per-arc side arrays match them, and
+		// every node reference is a valid index (middle may also be no_node)
+		bool isConsistent() const
+		{
+			size_t n = ids.size();
+			if (n >= no_node)
+			{
+				return false;
+			}
+			auto validOffsets = [n](const std::vector<size_t>& offsets, size_t arcs) {
+				if (offsets.size() != n + 1 || offsets[0] != 0 || offsets[n] != arcs)
+				{
+					return false;
+				}
+				for (size_t u = 0; u < n; ++u)
+				{
+					if (offsets[u] > offsets[u + 1])
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			auto validArcs = [n](const std::vector<Arc>& arcs, const std::vector<uint32_t>& nodes) {
+				if (arcs.size() != nodes.size())
+				{
+					return false;
+				}
+				for (size_t a = 0; a < arcs.size(); ++a)
+				{
+					if (arcs[a].target >= n || (arcs[a].middle != no_node && arcs[a].middle >= n) || nodes[a] >= n)
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			return validOffsets(up_offsets, up_arcs.size()) && validOffsets(down_offsets, down_arcs.size()) && validArcs(up_arcs, arc_source_up)
+				&& validArcs(down_arcs, arc_owner_down);
+		}
+
+		std::vector<V>				   ids;
+		std::unordered_map<V, uint32_t> index;
+		std::vector<size_t>			   up_offsets;
+		std::vector<Arc>			   up_arcs;
+		std::vector<uint32_t>		   arc_source_up;
+		std::vector<size_t>			   down_offsets;
+		std::vector<Arc>			   down_arcs;
+		std::vector<uint32_t>		   arc_owner_down;
+	};
+} // namespace graph
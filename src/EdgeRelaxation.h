@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+#include "ShortestPaths.h"
+
+// The vector kernels are compiled only when the compiler targets AVX2. The default build
+// leaves them out and every pass runs the scalar loop; configure with -DGRAPH_ENABLE_AVX2=ON
+// (which adds -mavx2 or /arch:AVX2) to get them
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace graph
+{
+	namespace detail
+	{
+		// Branchy reference kernel: out[t] = min(out[t], in[s] + w) over edges [0, count),
+		// skipping unreached sources. in and out may be the same array
+		template <typename W>
+		bool relaxEdgesScalar(const uint32_t* sources, const uint32_t* targets, const W* weights, size_t count, const W* in, W* out)
+		{
+			constexpr W inf = std::numeric_limits<W>::max();
+			bool		changed = false;
+			for (size_t e = 0; e < count; ++e)
+			{
+				W d = in[sources[e]];
+				if (d == inf)
+				{
+					continue;
+				}
+				W candidate = W(d + weights[e]);
+				if (candidate < out[targets[e]])
+				{
+					out[targets[e]] = candidate;
+					changed = true;
+				}
+			}
+			return changed;
+		}
+
+		// Eight-lane operations per weight type; enabled only where a vector kernel exists
+		template <typename W>
+		struct RelaxationLanes
+		{
+			static constexpr bool enabled = false;
+		};
+
+#if defined(__AVX2__)
+		template <>
+		struct RelaxationLanes<int32_t>
+		{
+			static constexpr bool enabled = true;
+			using Vector = __m256i;
+
+			static Vector load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+			static void	  store(int32_t* p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+			static Vector gather(const int32_t* base, __m256i index) { return _mm256_i32gather_epi32(base, index, 4); }
+			static Vector add(Vector a, Vector b) { return _mm256_add_epi32(a, b); }
+
+			// Bit i set when lane i has a reached source and a strictly smaller candidate
+			static int improved(Vector dist, Vector candidate, Vector current)
+			{
+				__m256i unreached = _mm256_cmpeq_epi32(dist, _mm256_set1_epi32(std::numeric_limits<int32_t>::max()));
+				__m256i better = _mm256_andnot_si256(unreached, _mm256_cmpgt_epi32(current, candidate));
+				return _mm256_movemask_ps(_mm256_castsi256_ps(better));
+			}
+		};
+
+		template <>
+		struct RelaxationLanes<uint32_t>
+		{
+			static constexpr bool enabled = true;
+			using Vector = __m256i;
+
+			static Vector load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+			static void	  store(uint32_t* p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+			static Vector gather(const uint32_t* base, __m256i index) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), index, 4); }
+			static Vector add(Vector a, Vector b) { return _mm256_add_epi32(a, b); }
+
+			// No unsigned compare in AVX2: candidate >= current exactly when max(candidate, current) == candidate
+			static int improved(Vector dist, Vector candidate, Vector current)
+			{
+				__m256i unreached = _mm256_cmpeq_epi32(dist, _mm256_set1_epi32(-1));
+				__m256i not_better = _mm256_cmpeq_epi32(_mm256_max_epu32(candidate, current), candidate);
+				return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(unreached, not_better))) & 0xFF;
+			}
+		};
+
+		template <>
+		struct RelaxationLanes<float>
+		{
+			static constexpr bool enabled = true;
+			using Vector = __m256;
+
+			static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+			static void	  store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+			static Vector gather(const float* base, __m256i index) { return _mm256_i32gather_ps(base, index, 4); }
+			static Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+
+			static int improved(Vector dist, Vector candidate, Vector current)
+			{
+				__m256 reached = _mm256_cmp_ps(dist, _mm256_set1_ps(std::numeric_limits<float>::max()), _CMP_NEQ_OQ);
+				return _mm256_movemask_ps(_mm256_and_ps(reached, _mm256_cmp_ps(candidate, current, _CMP_LT_OQ)));
+			}
+		};
+
+		// Eight edges per step: gather source and target distances, add the weights and compare
+		// without branching. AVX2 has neither scatter nor conflict detection, so the rare lanes
+		// that improve are stored one by one, each re-checked against memory; two lanes hitting
+		// the same target therefore keep the smaller candidate
+		template <typename W>
+		bool relaxEdgesVector(const uint32_t* sources, const uint32_t* targets, const W* weights, size_t count, const W* in, W* out)
+		{
+			using Lanes = RelaxationLanes<W>;
+			bool   changed = false;
+			size_t e = 0;
+			for (; e + 8 <= count; e += 8)
+			{
+				__m256i		 source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + e));
+				__m256i		 target = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(targets + e));
+				auto		 dist = Lanes::gather(in, source);
+				auto		 candidate = Lanes::add(dist, Lanes::load(weights + e));
+				unsigned int mask = Lanes::improved(dist, candidate, Lanes::gather(out, target));
+				if (mask == 0)
+				{
+					continue;
+				}
+
+				alignas(32) W		 values[8];
+				alignas(32) uint32_t indices[8];
+				Lanes::store(values, candidate);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(indices), target);
+				for (; mask; mask &= mask - 1)
+				{
+					int lane = std::countr_zero(mask);
+					if (values[lane] < out[indices[lane]])
+					{
+						out[indices[lane]] = values[lane];
+						changed = true;
+					}
+				}
+			}
+			return relaxEdgesScalar(sources + e, targets + e, weights + e, count - e, in, out) || changed;
+		}
+#endif
+
+		template <typename W>
+		bool relaxEdges(const uint32_t* sources, const uint32_t* targets, const W* weights, size_t count, const W* in, W* out)
+		{
+#if defined(__AVX2__)
+			if constexpr (RelaxationLanes<W>::enabled)
+			{
+				return relaxEdgesVector(sources, targets, weights, count, in, out);
+			}
+#endif
+			return relaxEdgesScalar(sources, targets, weights, count, in, out);
+		}
+	} // namespace detail
+
+	// Whether RelaxEdges runs on the vector kernel for this weight type in this build
+	template <typename W>
+	constexpr bool has_vector_relaxation = detail::RelaxationLanes<W>::enabled;
+
+	// One Bellman-Ford pass over the whole edge list, in place; true if any distance dropped.
+	// Vectorized for int32, uint32 and float weights when built with AVX2, scalar otherwise
+	template <typename W, typename V>
+	bool RelaxEdges(const EdgeList<W, V>& edges, std::vector<W>& dist)
+	{
+		return detail::relaxEdges(edges.sources.data(), edges.targets.data(), edges.weights.data(), edges.getEdgesCount(), dist.data(), dist.data());
+	}
+
+	// Sequential Bellman-Ford made of RelaxEdges passes; stops on the first pass that changes
+	// nothing. Starts from the given tentative distances (maximum W for "not reached yet")
+	template <typename W, typename V>
+	std::vector<W> VectorBellmanFord(const std::vector<W>& initial, const EdgeList<W, V>& edges)
+	{
+		std::vector<W> dist = initial;
+		size_t		   n = edges.getNodesCount();
+		bool		   changed = true;
+		for (size_t i = 0; changed && i + 1 < n; ++i)
+		{
+			changed = RelaxEdges(edges, dist);
+		}
+		if (changed && RelaxEdges(edges, dist))
+		{
+			throw std::runtime_error("Graph contains negative weight cycle");
+		}
+		return dist;
+	}
+
+	template <typename W, typename V>
+	std::vector<W> VectorBellmanFord(uint32_t from, const EdgeList<W, V>& edges)
+	{
+		std::vector<W> initial(edges.getNodesCount(), std::numeric_limits<W>::max());
+		initial[from] = 0;
+		return VectorBellmanFord(initial, edges);
+	}
+
+	template <typename W, typename V>
+	std::unordered_map<V, W> VectorBellmanFord(V from, const WGraph<W, V>& g)
+	{
+		EdgeList<W, V> edges = toEdgeList(toCSR(g));
+		return detail::toNodeMap(VectorBellmanFord(edges.index.at(from), edges), edges.ids);
+	}
+
+	// Parallel edge-centric SSSP with the relaxation kernel. Edges are regrouped by target so
+	// every worker owns a range of targets and writes them without atomics; each pass reads the
+	// previous pass's distances and writes the next ones (Jacobi order), which keeps reads and
+	// writes on separate arrays. Same pass bound and negative cycle check as Bellman-Ford
+	template <typename W, typename V>
+	std::vector<W> EdgeCentricSSSP(const std::vector<W>& initial, const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		size_t				  n = edges.getNodesCount();
+		size_t				  m = edges.getEdgesCount();
+		std::vector<uint32_t> offsets(n + 1, 0);
+		for (uint32_t target : edges.targets)
+		{
+			++offsets[target + 1];
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+		std::vector<uint32_t> sources(m), targets(m);
+		std::vector<W>		  weights(m);
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t e = 0; e < m; ++e)
+		{
+			uint32_t slot = cursor[edges.targets[e]]++;
+			sources[slot] = edges.sources[e];
+			targets[slot] = edges.targets[e];
+			weights[slot] = edges.weights[e];
+		}
+
+		std::vector<W> dist = initial, next(n);
+		auto		   pass = [&]() {
+			std::atomic<bool> changed(false);
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				std::copy(dist.begin() + begin, dist.begin() + end, next.begin() + begin);
+				size_t first = offsets[begin];
+				if (detail::relaxEdges(sources.data() + first, targets.data() + first, weights.data() + first, offsets[end] - first, dist.data(), next.data()))
+				{
+					changed.store(true, std::memory_order_relaxed);
+				}
+			});
+			dist.swap(next);
+			return changed.load();
+		};
+
+		bool changed = true;
+		for (size_t i = 0; changed && i + 1 < n; ++i)
+		{
+			changed = pass();
+		}
+		if (changed && pass())
+		{
+			throw std::runtime_error("Graph contains negative weight cycle");
+		}
+		return dist;
+	}
+
+	template <typename W, typename V>
+	std::vector<W> EdgeCentricSSSP(uint32_t from, const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		std::vector<W> initial(edges.getNodesCount(), std::numeric_limits<W>::max());
+		initial[from] = 0;
+		return EdgeCentricSSSP(initial, edges, pool);
+	}
+
+	template <typename W, typename V>
+	std::unordered_map<V, W> EdgeCentricSSSP(V from, const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		EdgeList<W, V>		 edges = toEdgeList(toCSR(g));
+		return detail::toNodeMap(EdgeCentricSSSP(edges.index.at(from), edges, pool), edges.ids);
+	}
+} // namespace graph
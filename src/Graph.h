@@ -6,6 +6,8 @@
 #include <queue>
 #include <stack>
 #include <deque>
+#include <vector>
+#include <algorithm>
 
 #pragma once
 
@@ -25,6 +27,7 @@ namespace graph
 
 			edges_to.insert(std::make_pair(n1, Edge(weight, n2)));
 			edges_from.insert(std::make_pair(n2, Edge(weight, n1)));
+			++version;
 		}
 
 		static V getEdgeDirection(Edge e)
@@ -42,6 +45,7 @@ namespace graph
 		EdgesArray edges_to;
 		EdgesArray edges_from;
 		NodesArray nodes;
+		size_t	   version = 0; // bumped on every change so cached results can detect staleness
 	};
 
 	template <typename V = int>
@@ -72,50 +76,77 @@ namespace graph
 		NodesArray nodes;
 	};
 
+	// Result of a single-source run: costs of every node (maximum W if unreachable) and the
+	// predecessor each reachable node was last relaxed from. Any number of paths can be read
+	// from one run, each in O(path length)
 	template <typename W = unsigned int, typename V = int>
-	std::pair<std::vector<V>, W> findPath(V from, V to, const WGraph<W, V>& graph)
+	struct ShortestPathTree
 	{
-		std::unordered_map<V, W> res;
+		bool isReachable(V to) const
+		{
+			auto it = costs.find(to);
+			return it != costs.end() && it->second != std::numeric_limits<W>::max();
+		}
 
-		if constexpr (std::is_unsigned_v<W>)
+		W getCost(V to) const
 		{
-			res = Dijkstra<W, V>(from, graph);
+			auto it = costs.find(to);
+			return it == costs.end() ? std::numeric_limits<W>::max() : it->second;
 		}
-		else
+
+		// Path from source to "to" inclusive, empty if "to" is unreachable
+		std::vector<V> getPath(V to) const
 		{
-			res = Bellman_Ford<W, V>(from, graph);
+			std::vector<V> path;
+			if (!isReachable(to))
+			{
+				return path;
+			}
+			path.push_back(to);
+			while (path.back() != source)
+			{
+				path.push_back(parents.at(path.back()));
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
 		}
 
-		std::pair<std::vector<V>, W> ret;
-		ret.second = res[to];
-		ret.first.push_back(to);
+		V						 source {};
+		std::unordered_map<V, W> costs;
+		std::unordered_map<V, V> parents;
+	};
 
-		const typename WGraph<W, V>::EdgesArray& edges_from = graph.edges_from;
+	// Point-to-point search strategy used by findPath on weighted graphs
+	enum class SearchPolicy
+	{
+		SingleSource,  // full Dijkstra (Bellman-Ford for signed weights) and its shortest-path tree
+		Bidirectional, // Dijkstra from both ends, stops once the frontiers meet
+		AStar		   // goal-directed search guided by the supplied heuristic (e.g. ALTHeuristic)
+	};
+
+	// Heuristic that turns A* into plain Dijkstra
+	template <typename W = unsigned int, typename V = int>
+	struct ZeroHeuristic
+	{
+		W operator()(V, V) const { return 0; }
+	};
 
-		V current = to;
-		while (current != from)
+	// Bidirectional and A* policies require non-negative weights;
+	// an unreachable target yields an empty path and the maximum W
+	template <typename W = unsigned int, typename V = int, typename Heuristic = ZeroHeuristic<W, V>>
+	std::pair<std::vector<V>, W> findPath(V from, V to, const WGraph<W, V>& graph, SearchPolicy policy = SearchPolicy::SingleSource, const Heuristic& heuristic = Heuristic())
+	{
+		if (policy == SearchPolicy::Bidirectional)
 		{
-			auto range = edges_from.equal_range(current);
-			for (auto it = range.first; it != range.second; ++it)
-			{
-				if (res[current] == it->second.first + res[it->second.second])
-				{
-					if (from != it->second.second)
-					{
-						ret.first.push_back(it->second.second);
-					}
-					current = it->second.second;
-					break;
-				}
-			}
+			return BidirectionalDijkstra(from, to, graph);
 		}
-		ret.first.push_back(from);
-		if (ret.first.size() > 1)
+		if (policy == SearchPolicy::AStar)
 		{
-			std::reverse(ret.first.begin(), ret.first.end());
+			return AStar(from, to, graph, heuristic);
 		}
 
-		return ret;
+		ShortestPathTree<W, V> tree = getShortestPathTree(from, graph);
+		return std::make_pair(tree.getPath(to), tree.getCost(to));
 	}
 
 	template <typename V = unsigned int>
@@ -356,12 +387,12 @@ namespace graph
 		return res;
 	}
 
+	// When parents is given, every node reached is mapped to its predecessor on a shortest path
 	template <typename W, typename V>
-	std::unordered_map<V, W> Dijkstra(V from, const WGraph<W, V>& g)
+	std::unordered_map<V, W> Dijkstra(V from, const WGraph<W, V>& g, std::unordered_map<V, V>* parents = nullptr)
 	{
 		std::unordered_map<V, W>																		  costs;
 		std::priority_queue<std::pair<W, V>, std::vector<std::pair<W, V>>, std::greater<std::pair<W, V>>> heap;
-		std::set<V>																						  nodes_remain = g.nodes;
 		for (auto i : g.nodes)
 		{
 			costs[i] = std::numeric_limits<W>::max();
@@ -374,17 +405,23 @@ namespace graph
 		{
 			auto top = heap.top();
 			heap.pop();
-			nodes_remain.erase(top.second);
-			if (costs[top.second] > top.first)
+			if (top.first > costs[top.second])
 			{
-				costs[top.second] = top.first;
+				continue;
 			}
 			auto range = g.edges_to.equal_range(top.second);
 			for (auto it = range.first; it != range.second; ++it)
 			{
-				if (nodes_remain.count(it->second.second) == 1)
+				W  new_cost = it->second.first + top.first;
+				W& cost = costs.find(it->second.second)->second;
+				if (new_cost < cost)
 				{
-					heap.push(std::make_pair(it->second.first + costs[top.second], it->second.second));
+					cost = new_cost;
+					if (parents)
+					{
+						(*parents)[it->second.second] = top.second;
+					}
+					heap.push(std::make_pair(new_cost, it->second.second));
 				}
 			}
 		}
@@ -392,7 +429,7 @@ namespace graph
 	}
 
 	template <typename W, typename V>
-	std::unordered_map<V, W> Bellman_Ford(V from, const WGraph<W, V>& g)
+	std::unordered_map<V, W> Bellman_Ford(V from, const WGraph<W, V>& g, std::unordered_map<V, V>* parents = nullptr)
 	{
 		std::unordered_map<V, W> res;
 		for (auto i : g.nodes)
@@ -401,28 +438,44 @@ namespace graph
 		}
 		res[from] = 0;
 
-		for (size_t i = 0; i < g.getNodesCount() - 1; ++i)
+		// stops as soon as a pass changes nothing, a converged pass also rules out negative cycles
+		bool changed = true;
+		for (size_t i = 0; changed && i + 1 < g.getNodesCount(); ++i)
 		{
+			changed = false;
 			for (auto it = g.edges_to.begin(); it != g.edges_to.end(); ++it)
 			{
 				auto& edge = *it;
-				if (res[edge.first] == std::numeric_limits<W>::max())
+				W	  from_cost = res.find(edge.first)->second;
+				if (from_cost == std::numeric_limits<W>::max())
 				{
 					continue;
 				}
 
-				W new_weight = res[edge.first] + edge.second.first;
-				if (res[edge.second.second] > new_weight)
+				W	new_weight = from_cost + edge.second.first;
+				W& to_cost = res.find(edge.second.second)->second;
+				if (to_cost > new_weight)
 				{
-					res[edge.second.second] = new_weight;
+					to_cost = new_weight;
+					changed = true;
+					if (parents)
+					{
+						(*parents)[edge.second.second] = edge.first;
+					}
 				}
 			}
 		}
 
+		if (!changed)
+		{
+			return res;
+		}
+
 		for (auto it = g.edges_to.begin(); it != g.edges_to.end(); ++it)
 		{
 			auto& edge = *it;
-			if (res[edge.first] == std::numeric_limits<W>::max() || res[edge.second.second] > (res[edge.first] + edge.second.first))
+			W	  from_cost = res.find(edge.first)->second;
+			if (from_cost != std::numeric_limits<W>::max() && res.find(edge.second.second)->second > (from_cost + edge.second.first))
 			{
 				throw std::exception("Graph contains negative weight cycle");
 			}
@@ -431,4 +484,282 @@ namespace graph
 		return res;
 	}
 
+	// Dijkstra for unsigned weights, Bellman-Ford otherwise, with predecessors recorded
+	template <typename W, typename V>
+	ShortestPathTree<W, V> getShortestPathTree(V from, const WGraph<W, V>& g)
+	{
+		ShortestPathTree<W, V> tree;
+		tree.source = from;
+		if constexpr (std::is_unsigned_v<W>)
+		{
+			tree.costs = Dijkstra(from, g, &tree.parents);
+		}
+		else
+		{
+			tree.costs = Bellman_Ford(from, g, &tree.parents);
+		}
+		return tree;
+	}
+
+	namespace detail
+	{
+		template <typename V>
+		std::vector<V> unwindPath(V from, V to, const std::unordered_map<V, V>& parents)
+		{
+			std::vector<V> path(1, to);
+			while (path.back() != from)
+			{
+				path.push_back(parents.at(path.back()));
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		// Dijkstra over an arbitrary adjacency (edges_to or edges_from), writes dense distances
+		template <typename W, typename V>
+		void denseDijkstra(V from, const typename WGraph<W, V>::EdgesArray& edges, const std::unordered_map<V, size_t>& index, std::vector<W>& dist)
+		{
+			using QueueItem = std::pair<W, V>;
+			std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> heap;
+
+			dist.assign(index.size(), std::numeric_limits<W>::max());
+			dist[index.at(from)] = 0;
+			heap.push(std::make_pair(W(0), from));
+			while (!heap.empty())
+			{
+				auto [d, node] = heap.top();
+				heap.pop();
+				if (d > dist[index.at(node)])
+				{
+					continue;
+				}
+				auto range = edges.equal_range(node);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					W&	next_dist = dist[index.at(it->second.second)];
+					W	new_dist = d + it->second.first;
+					if (new_dist < next_dist)
+					{
+						next_dist = new_dist;
+						heap.push(std::make_pair(new_dist, it->second.second));
+					}
+				}
+			}
+		}
+	} // namespace detail
+
+	// Runs Dijkstra simultaneously from "from" over edges_to and from "to" over edges_from,
+	// alternating on the smaller frontier key and stopping once both keys sum past the best meeting point
+	template <typename W, typename V>
+	std::pair<std::vector<V>, W> BidirectionalDijkstra(V from, V to, const WGraph<W, V>& g)
+	{
+		using QueueItem = std::pair<W, V>;
+		using Heap = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+		constexpr W				 inf = std::numeric_limits<W>::max();
+		std::unordered_map<V, W> dist[2];
+		std::unordered_map<V, V> parents[2];
+		Heap					 heaps[2];
+		const typename WGraph<W, V>::EdgesArray* edges[2] = { &g.edges_to, &g.edges_from };
+
+		if (g.nodes.count(from) == 0 || g.nodes.count(to) == 0)
+		{
+			return std::make_pair(std::vector<V>(), inf);
+		}
+		if (from == to)
+		{
+			return std::make_pair(std::vector<V>(1, from), W(0));
+		}
+
+		dist[0][from] = 0;
+		dist[1][to] = 0;
+		heaps[0].push(std::make_pair(W(0), from));
+		heaps[1].push(std::make_pair(W(0), to));
+
+		W best = inf;
+		V meeting = from;
+		while (!heaps[0].empty() && !heaps[1].empty())
+		{
+			W top_sum = heaps[0].top().first + heaps[1].top().first;
+			if (best != inf && top_sum >= best)
+			{
+				break;
+			}
+
+			int	 side = heaps[0].top().first <= heaps[1].top().first ? 0 : 1;
+			auto [d, node] = heaps[side].top();
+			heaps[side].pop();
+			if (d > dist[side][node])
+			{
+				continue;
+			}
+
+			auto range = edges[side]->equal_range(node);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				V	 next = it->second.second;
+				W	 new_dist = d + it->second.first;
+				auto found = dist[side].find(next);
+				if (found == dist[side].end() || new_dist < found->second)
+				{
+					dist[side][next] = new_dist;
+					parents[side][next] = node;
+					heaps[side].push(std::make_pair(new_dist, next));
+				}
+
+				auto other = dist[1 - side].find(next);
+				if (other != dist[1 - side].end() && new_dist + other->second < best)
+				{
+					best = new_dist + other->second;
+					meeting = next;
+				}
+			}
+		}
+
+		if (best == inf)
+		{
+			return std::make_pair(std::vector<V>(), inf);
+		}
+
+		std::vector<V> path = detail::unwindPath(from, meeting, parents[0]);
+		for (V node = meeting; node != to;)
+		{
+			node = parents[1].at(node);
+			path.push_back(node);
+		}
+		return std::make_pair(std::move(path), best);
+	}
+
+	// A* search, heuristic(node, target) must never overestimate the remaining distance;
+	// nodes are reopened when a shorter path is found, so inconsistent heuristics stay exact
+	template <typename W, typename V, typename Heuristic>
+	std::pair<std::vector<V>, W> AStar(V from, V to, const WGraph<W, V>& g, const Heuristic& heuristic)
+	{
+		using QueueItem = std::pair<W, V>;
+
+		constexpr W																	   inf = std::numeric_limits<W>::max();
+		std::unordered_map<V, W>													   dist;
+		std::unordered_map<V, V>													   parents;
+		std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> heap;
+
+		if (g.nodes.count(from) == 0 || g.nodes.count(to) == 0)
+		{
+			return std::make_pair(std::vector<V>(), inf);
+		}
+
+		dist[from] = 0;
+		heap.push(std::make_pair(heuristic(from, to), from));
+		while (!heap.empty())
+		{
+			auto [estimate, node] = heap.top();
+			heap.pop();
+			W d = dist[node];
+			if (estimate > d + heuristic(node, to))
+			{
+				continue;
+			}
+			if (node == to)
+			{
+				return std::make_pair(detail::unwindPath(from, to, parents), d);
+			}
+
+			auto range = g.edges_to.equal_range(node);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				V	 next = it->second.second;
+				W	 new_dist = d + it->second.first;
+				auto found = dist.find(next);
+				if (found == dist.end() || new_dist < found->second)
+				{
+					dist[next] = new_dist;
+					parents[next] = node;
+					heap.push(std::make_pair(new_dist + heuristic(next, to), next));
+				}
+			}
+		}
+		return std::make_pair(std::vector<V>(), inf);
+	}
+
+	// ALT (A*, Landmarks, Triangle inequality) lower bounds. Landmarks are picked once by
+	// farthest-point selection and exact distances to and from each of them are stored densely;
+	// by the triangle inequality d(v, t) >= max(d(L, t) - d(L, v), d(v, L) - d(t, L))
+	template <typename W = unsigned int, typename V = int>
+	class ALTHeuristic
+	{
+	public:
+		ALTHeuristic(const WGraph<W, V>& g, size_t landmarks_count)
+		{
+			for (V node : g.nodes)
+			{
+				index.emplace(node, index.size());
+			}
+			if (g.nodes.empty())
+			{
+				return;
+			}
+
+			// the farthest-point choice spreads landmarks towards the periphery where bounds are tight
+			std::vector<W> closest(index.size(), std::numeric_limits<W>::max());
+			V			   next = *g.nodes.begin();
+			for (size_t i = 0; i < landmarks_count && i < index.size(); ++i)
+			{
+				landmarks.push_back(next);
+				from_landmark.emplace_back();
+				to_landmark.emplace_back();
+				detail::denseDijkstra<W, V>(next, g.edges_to, index, from_landmark.back());
+				detail::denseDijkstra<W, V>(next, g.edges_from, index, to_landmark.back());
+
+				W farthest = 0;
+				for (auto& [node, idx] : index)
+				{
+					closest[idx] = std::min(closest[idx], from_landmark.back()[idx]);
+					if (closest[idx] != std::numeric_limits<W>::max() && closest[idx] > farthest)
+					{
+						farthest = closest[idx];
+						next = node;
+					}
+				}
+				if (farthest == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		W operator()(V node, V target) const
+		{
+			constexpr W inf = std::numeric_limits<W>::max();
+			auto		node_it = index.find(node);
+			auto		target_it = index.find(target);
+			if (node_it == index.end() || target_it == index.end())
+			{
+				return 0;
+			}
+
+			W bound = 0;
+			for (size_t i = 0; i < landmarks.size(); ++i)
+			{
+				W lv = from_landmark[i][node_it->second], lt = from_landmark[i][target_it->second];
+				if (lv != inf && lt != inf && lt > lv)
+				{
+					bound = std::max<W>(bound, lt - lv);
+				}
+				W vl = to_landmark[i][node_it->second], tl = to_landmark[i][target_it->second];
+				if (vl != inf && tl != inf && vl > tl)
+				{
+					bound = std::max<W>(bound, vl - tl);
+				}
+			}
+			return bound;
+		}
+
+		const std::vector<V>& getLandmarks() const { return landmarks; }
+
+	private:
+		std::unordered_map<V, size_t> index;
+		std::vector<V>				  landmarks;
+		std::vector<std::vector<W>>	  from_landmark;
+		std::vector<std::vector<W>>	  to_landmark;
+	};
+
 } // namespace graph
\ No newline at end of file
@@ -0,0 +1,671 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace graph
+{
+	// On-disk CSR layout (native endianness). Every section starts on a 64-byte boundary so
+	// that mapped arrays can be used in place:
+	//   header | offsets: u64[n + 1] | targets: u32[m] | weights: W[m] (weighted only)
+	//   | ids: V[n] | id_order: u32[n] (dense indices sorted by id, for lookups)
+	struct BinaryGraphHeader
+	{
+		static constexpr uint32_t magic_value = 0x48505247; // "GRPH"
+		static constexpr uint32_t current_version = 1;
+		static constexpr uint32_t weighted_flag = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint32_t flags;
+		uint32_t weight_size;
+		uint32_t vertex_size;
+		uint32_t weight_kind; // 0 unsigned, 1 signed, 2 floating point
+		uint64_t nodes;
+		uint64_t edges;
+		uint64_t offsets_pos;
+		uint64_t targets_pos;
+		uint64_t weights_pos;
+		uint64_t ids_pos;
+		uint64_t id_order_pos;
+	};
+
+	namespace detail
+	{
+		inline uint64_t alignSection(uint64_t pos)
+		{
+			return (pos + 63) & ~uint64_t(63);
+		}
+
+		template <typename W>
+		constexpr uint32_t weightKind()
+		{
+			return std::is_floating_point_v<W> ? 2 : std::is_signed_v<W> ? 1 : 0;
+		}
+	} // namespace detail
+
+	template <typename W, typename V>
+	void writeBinaryGraph(const CSRGraph<W, V>& g, const std::string& path)
+	{
+		static_assert(std::is_trivially_copyable_v<V> && std::is_trivially_copyable_v<W>, "Binary format needs trivially copyable V and W");
+
+		uint64_t		  n = g.getNodesCount(), m = g.getEdgesCount();
+		BinaryGraphHeader header {};
+		header.magic = BinaryGraphHeader::magic_value;
+		header.version = BinaryGraphHeader::current_version;
+		header.flags = g.weights.empty() ? 0 : BinaryGraphHeader::weighted_flag;
+		header.weight_size = sizeof(W);
+		header.vertex_size = sizeof(V);
+		header.weight_kind = detail::weightKind<W>();
+		header.nodes = n;
+		header.edges = m;
+		header.offsets_pos = detail::alignSection(sizeof(BinaryGraphHeader));
+		header.targets_pos = detail::alignSection(header.offsets_pos + (n + 1) * sizeof(uint64_t));
+		header.weights_pos = detail::alignSection(header.targets_pos + m * sizeof(uint32_t));
+		header.ids_pos = detail::alignSection(header.weights_pos + (g.weights.empty() ? 0 : m * sizeof(W)));
+		header.id_order_pos = detail::alignSection(header.ids_pos + n * sizeof(V));
+
+		std::vector<uint64_t> offsets(g.offsets.begin(), g.offsets.end());
+		std::vector<uint32_t> id_order(n);
+		std::iota(id_order.begin(), id_order.end(), 0u);
+		std::sort(id_order.begin(), id_order.end(), [&](uint32_t a, uint32_t b) { return g.ids[a] < g.ids[b]; });
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		uint64_t	  written = 0;
+		auto		  section = [&](uint64_t pos, const void* data, uint64_t bytes) {
+			 static const char zeros[64] = {};
+			 out.write(zeros, static_cast<std::streamsize>(pos - written));
+			 out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+			 written = pos + bytes;
+		};
+		section(0, &header, sizeof(header));
+		section(header.offsets_pos, offsets.data(), offsets.size() * sizeof(uint64_t));
+		section(header.targets_pos, g.targets.data(), m * sizeof(uint32_t));
+		section(header.weights_pos, g.weights.data(), g.weights.size() * sizeof(W));
+		section(header.ids_pos, g.ids.data(), n * sizeof(V));
+		section(header.id_order_pos, id_order.data(), n * sizeof(uint32_t));
+		if (!out)
+		{
+			throw std::runtime_error("Failed to write graph file " + path);
+		}
+	}
+
+	template <typename W, typename V>
+	void writeBinaryGraph(const WGraph<W, V>& g, const std::string& path)
+	{
+		writeBinaryGraph(toCSR(g), path);
+	}
+
+	// Read-only graph served straight from a memory-mapped binary graph file: opening costs
+	// one mmap plus validation of the header, section bounds and index arrays; weights and
+	// ids are paged in by the OS on first touch
+	template <typename W = unsigned int, typename V = int>
+	class MappedGraph
+	{
+	public:
+		using Weight = W;
+		using Vertex = V;
+
+		explicit MappedGraph(const std::string& path)
+		{
+			map(path);
+			if (size < sizeof(BinaryGraphHeader))
+			{
+				unmap();
+				throw std::runtime_error("Graph file is too small: " + path);
+			}
+
+			BinaryGraphHeader header;
+			std::memcpy(&header, base, sizeof(header));
+			if (header.magic != BinaryGraphHeader::magic_value || header.version != BinaryGraphHeader::current_version)
+			{
+				unmap();
+				throw std::runtime_error("Not a binary graph file or unsupported version: " + path);
+			}
+			if (header.weight_size != sizeof(W) || header.weight_kind != detail::weightKind<W>() || header.vertex_size != sizeof(V))
+			{
+				unmap();
+				throw std::runtime_error("Graph file was written with different W or V: " + path);
+			}
+			bool weighted = header.flags & BinaryGraphHeader::weighted_flag;
+			if (header.nodes >= std::numeric_limits<uint32_t>::max() || !fits<uint64_t>(header.offsets_pos, header.nodes + 1)
+				|| !fits<uint32_t>(header.targets_pos, header.edges) || (weighted && !fits<W>(header.weights_pos, header.edges))
+				|| !fits<V>(header.ids_pos, header.nodes) || !fits<uint32_t>(header.id_order_pos, header.nodes))
+			{
+				unmap();
+				throw std::runtime_error("Truncated graph file: " + path);
+			}
+
+			nodes = header.nodes;
+			edges = header.edges;
+			offsets = reinterpret_cast<const uint64_t*>(base + header.offsets_pos);
+			targets = reinterpret_cast<const uint32_t*>(base + header.targets_pos);
+			weights = weighted ? reinterpret_cast<const W*>(base + header.weights_pos) : nullptr;
+			ids = reinterpret_cast<const V*>(base + header.ids_pos);
+			id_order = reinterpret_cast<const uint32_t*>(base + header.id_order_pos);
+			if (!isConsistent())
+			{
+				unmap();
+				throw std::runtime_error("Corrupted graph file: " + path);
+			}
+		}
+
+		MappedGraph(const MappedGraph&) = delete;
+		MappedGraph& operator=(const MappedGraph&) = delete;
+
+		MappedGraph(MappedGraph&& other) noexcept { swap(other); }
+
+		MappedGraph& operator=(MappedGraph&& other) noexcept
+		{
+			swap(other);
+			return *this;
+		}
+
+		~MappedGraph() { unmap(); }
+
+		size_t getNodesCount() const { return nodes; }
+
+		size_t getEdgesCount() const { return edges; }
+
+		W getWeight(size_t edge) const { return weights ? weights[edge] : W(1); }
+
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e)
+			{
+				f(targets[e], getWeight(e));
+			}
+		}
+
+		// Binary search over the stored id order, no hash map is built on load
+		uint32_t getIndex(V node) const
+		{
+			const uint32_t* it = std::lower_bound(id_order, id_order + nodes, node, [&](uint32_t idx, const V& key) { return ids[idx] < key; });
+			if (it == id_order + nodes || ids[*it] != node)
+			{
+				throw std::out_of_range("Node is not in the graph");
+			}
+			return *it;
+		}
+
+		const uint64_t* offsets = nullptr;
+		const uint32_t* targets = nullptr;
+		const W*		weights = nullptr;
+		const V*		ids = nullptr;
+
+	private:
+		// Whether count Ts at pos lie inside the mapping, suitably aligned
+		template <typename T>
+		bool fits(uint64_t pos, uint64_t count) const
+		{
+			return pos % alignof(T) == 0 && pos <= size && count <= (size - pos) / sizeof(T);
+		}
+
+		// Offsets start at 0, never decrease and end at the edge count; every target and
+		// id_order entry is a valid node index. One sequential pass over the index arrays
+		bool isConsistent() const
+		{
+			if (offsets[0] != 0 || offsets[nodes] != edges)
+			{
+				return false;
+			}
+			for (size_t u = 0; u < nodes; ++u)
+			{
+				if (offsets[u] > offsets[u + 1] || id_order[u] >= nodes)
+				{
+					return false;
+				}
+			}
+			return std::all_of(targets, targets + edges, [this](uint32_t v) { return v < nodes; });
+		}
+
+		void swap(MappedGraph& other) noexcept
+		{
+			std::swap(offsets, other.offsets);
+			std::swap(targets, other.targets);
+			std::swap(weights, other.weights);
+			std::swap(ids, other.ids);
+			std::swap(base, other.base);
+			std::swap(size, other.size);
+			std::swap(nodes, other.nodes);
+			std::swap(edges, other.edges);
+			std::swap(id_order, other.id_order);
+#ifdef _WIN32
+			std::swap(file, other.file);
+			std::swap(mapping, other.mapping);
+#endif
+		}
+
+		void map(const std::string& path)
+		{
+#ifdef _WIN32
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER file_size;
+			if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size))
+			{
+				unmap();
+				throw std::runtime_error("Cannot open graph file " + path);
+			}
+			size = static_cast<size_t>(file_size.QuadPart);
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			base = mapping ? static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+			int			fd = ::open(path.c_str(), O_RDONLY);
+			struct stat st;
+			if (fd < 0 || ::fstat(fd, &st) != 0)
+			{
+				if (fd >= 0)
+				{
+					::close(fd);
+				}
+				throw std::runtime_error("Cannot open graph file " + path);
+			}
+			size = static_cast<size_t>(st.st_size);
+			void* addr = size ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			::close(fd);
+			base = addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+#endif
+			if (!base)
+			{
+				unmap();
+				throw std::runtime_error("Cannot map graph file " + path);
+			}
+		}
+
+		void unmap()
+		{
+#ifdef _WIN32
+			if (base)
+			{
+				UnmapViewOfFile(base);
+			}
+			if (mapping)
+			{
+				CloseHandle(mapping);
+			}
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file);
+			}
+			file = INVALID_HANDLE_VALUE;
+			mapping = nullptr;
+#else
+			if (base)
+			{
+				::munmap(const_cast<char*>(base), size);
+			}
+#endif
+			base = nullptr;
+		}
+
+		const char*		base = nullptr;
+		size_t			size = 0;
+		size_t			nodes = 0;
+		size_t			edges = 0;
+		const uint32_t* id_order = nullptr;
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+	};
+
+	// What to do with repeated (source, target) pairs when importing an edge list
+	enum class ParallelEdges
+	{
+		Keep,
+		KeepFirst,	   // first occurrence in file order
+		KeepMinWeight
+	};
+
+	struct EdgeListImportOptions
+	{
+		bool		  weighted = true;				// third column; missing weights count as 1
+		ParallelEdges parallel_edges = ParallelEdges::Keep;
+		size_t		  chunk_bytes = size_t(64) << 20; // read buffer, bounds memory beyond the edges themselves
+		size_t		  threads = 0;
+	};
+
+	namespace detail
+	{
+		// SWAR check that 8 bytes are all ASCII digits
+		inline bool eightDigits(uint64_t chunk)
+		{
+			return ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+		}
+
+		// Folds 8 little-endian ASCII digits into their value with three multiplies
+		inline uint32_t parseEightDigits(uint64_t chunk)
+		{
+			chunk -= 0x3030303030303030;
+			chunk = (chunk * 10) + (chunk >> 8);
+			return static_cast<uint32_t>((((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32)))
+											 + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))))
+				>> 32);
+		}
+
+		// Parses an optionally signed integer at p, false if none is there or it does not fit T
+		// (a minus sign for unsigned T included)
+		template <typename T>
+		bool parseInteger(const char*& p, const char* end, T& value)
+		{
+			bool negative = false;
+			if (p < end && *p == '-')
+			{
+				negative = true;
+				++p;
+			}
+			if (p == end || static_cast<unsigned char>(*p - '0') > 9 || (negative && !std::is_signed_v<T>))
+			{
+				return false;
+			}
+
+			constexpr uint64_t max = std::numeric_limits<uint64_t>::max();
+			uint64_t		   acc = 0;
+			bool			   overflow = false;
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				uint64_t chunk;
+				while (end - p >= 8 && (std::memcpy(&chunk, p, 8), eightDigits(chunk)))
+				{
+					uint32_t digits = parseEightDigits(chunk);
+					overflow |= acc > (max - digits) / 100000000;
+					acc = acc * 100000000 + digits;
+					p += 8;
+				}
+			}
+			while (p < end && static_cast<unsigned char>(*p - '0') <= 9)
+			{
+				unsigned digit = static_cast<unsigned char>(*p - '0');
+				overflow |= acc > (max - digit) / 10;
+				acc = acc * 10 + digit;
+				++p;
+			}
+
+			uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+			if (overflow || acc > limit)
+			{
+				return false;
+			}
+			value = negative ? static_cast<T>(0 - acc) : static_cast<T>(acc);
+			return true;
+		}
+
+		template <typename T>
+		bool parseNumber(const char*& p, const char* end, T& value)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				auto [next, error] = std::from_chars(p, end, value);
+				if (error != std::errc())
+				{
+					return false;
+				}
+				p = next;
+				return true;
+			}
+			else
+			{
+				return parseInteger(p, end, value);
+			}
+		}
+
+		inline void skipBlanks(const char*& p, const char* end)
+		{
+			while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ','))
+			{
+				++p;
+			}
+		}
+
+		// Raw edges of one thread, ids are not yet dense
+		template <typename W, typename V>
+		struct ParsedEdges
+		{
+			std::vector<V> sources;
+			std::vector<V> targets;
+			std::vector<W> weights;
+		};
+
+		// Parses whole lines in [p, end), '#' and '%' lines are comments. Throws on a line that
+		// does not start with two numbers or, for weighted input, has an unparsable weight
+		template <typename W, typename V>
+		void parseLines(const char* p, const char* end, bool weighted, ParsedEdges<W, V>& out)
+		{
+			auto atLineEnd = [&]() { return p == end || *p == '\n'; };
+			while (p < end)
+			{
+				skipBlanks(p, end);
+				if (!atLineEnd() && *p != '#' && *p != '%')
+				{
+					V from, to;
+					if (!parseNumber(p, end, from))
+					{
+						throw std::runtime_error("Malformed edge list line");
+					}
+					skipBlanks(p, end);
+					if (!parseNumber(p, end, to))
+					{
+						throw std::runtime_error("Malformed edge list line");
+					}
+					out.sources.push_back(from);
+					out.targets.push_back(to);
+					if (weighted)
+					{
+						skipBlanks(p, end);
+						W weight = 1;
+						if (!atLineEnd() && !parseNumber(p, end, weight))
+						{
+							throw std::runtime_error("Malformed edge list line");
+						}
+						out.weights.push_back(weight);
+					}
+				}
+				while (!atLineEnd())
+				{
+					++p;
+				}
+				++p;
+			}
+		}
+
+		// Sorts each adjacency by target (stable, so file order survives among equal targets)
+		// and keeps one edge per target
+		template <typename W, typename V>
+		CSRGraph<W, V> dropParallelEdges(CSRGraph<W, V>&& g, ParallelEdges policy, parallel::ThreadPool& pool)
+		{
+			size_t				n = g.getNodesCount();
+			std::vector<size_t> kept(n + 1, 0);
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				std::vector<std::pair<uint32_t, W>> adjacency;
+				for (size_t u = begin; u < end; ++u)
+				{
+					adjacency.clear();
+					for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+					{
+						adjacency.emplace_back(g.targets[e], g.getWeight(e));
+					}
+					if (policy == ParallelEdges::KeepMinWeight)
+					{
+						std::sort(adjacency.begin(), adjacency.end());
+					}
+					else
+					{
+						std::stable_sort(adjacency.begin(), adjacency.end(), [](auto& a, auto& b) { return a.first < b.first; });
+					}
+					auto last = std::unique(adjacency.begin(), adjacency.end(), [](auto& a, auto& b) { return a.first == b.first; });
+					size_t out = g.offsets[u];
+					for (auto it = adjacency.begin(); it != last; ++it, ++out)
+					{
+						g.targets[out] = it->first;
+						if (!g.weights.empty())
+						{
+							g.weights[out] = it->second;
+						}
+					}
+					kept[u + 1] = out - g.offsets[u];
+				}
+			});
+
+			// compact the per-node prefixes into contiguous arrays
+			for (size_t u = 0; u < n; ++u)
+			{
+				kept[u + 1] += kept[u];
+			}
+			for (size_t u = 0; u < n; ++u)
+			{
+				size_t count = kept[u + 1] - kept[u];
+				std::copy_n(g.targets.begin() + g.offsets[u], count, g.targets.begin() + kept[u]);
+				if (!g.weights.empty())
+				{
+					std::copy_n(g.weights.begin() + g.offsets[u], count, g.weights.begin() + kept[u]);
+				}
+			}
+			g.targets.resize(kept[n]);
+			if (!g.weights.empty())
+			{
+				g.weights.resize(kept[n]);
+			}
+			g.offsets = std::move(kept);
+			return std::move(g);
+		}
+	} // namespace detail
+
+	// Streaming "u v [w]" importer that builds CSR directly, without WGraph::addEdge.
+	// The input is read in chunks of options.chunk_bytes, each split at line boundaries and
+	// parsed in parallel; ids are made dense by a parallel sort of all seen ids followed by a
+	// binary search per endpoint, and edges are bucketed by source with a counting sort.
+	// Dense indices follow ascending id order, as with toCSR
+	template <typename W = unsigned int, typename V = int>
+	CSRGraph<W, V> importEdgeList(std::istream& in, const EdgeListImportOptions& options = EdgeListImportOptions())
+	{
+		static_assert(std::is_integral_v<V>, "Edge list ids must be integers");
+
+		parallel::ThreadPool						 pool(options.threads);
+		size_t										 workers = pool.getThreadsCount();
+		std::vector<detail::ParsedEdges<W, V>>		 parsed(workers);
+		detail::ParsedEdges<W, V>					 all;
+		std::vector<char>							 buffer(std::max<size_t>(options.chunk_bytes, 1 << 16));
+		size_t										 carry = 0;
+
+		while (in)
+		{
+			in.read(buffer.data() + carry, static_cast<std::streamsize>(buffer.size() - carry));
+			size_t filled = carry + static_cast<size_t>(in.gcount());
+			if (filled == 0)
+			{
+				break;
+			}
+
+			// only complete lines are parsed, the tail moves to the front of the next chunk
+			size_t complete = filled;
+			if (in)
+			{
+				while (complete > 0 && buffer[complete - 1] != '\n')
+				{
+					--complete;
+				}
+				if (complete == 0)
+				{
+					buffer.resize(buffer.size() * 2);
+					carry = filled;
+					continue;
+				}
+			}
+
+			std::vector<size_t> cuts(workers + 1, complete);
+			cuts[0] = 0;
+			for (size_t w = 1; w < workers; ++w)
+			{
+				size_t cut = std::max(cuts[w - 1], complete * w / workers);
+				while (cut > 0 && cut < complete && buffer[cut - 1] != '\n')
+				{
+					++cut;
+				}
+				cuts[w] = cut;
+			}
+			pool.parallelFor(workers, [&](size_t begin, size_t end, size_t) {
+				for (size_t w = begin; w < end; ++w)
+				{
+					detail::parseLines(buffer.data() + cuts[w], buffer.data() + cuts[w + 1], options.weighted, parsed[w]);
+				}
+			}, 1);
+
+			// appended in worker order so the edges stay in file order
+			for (auto& part : parsed)
+			{
+				all.sources.insert(all.sources.end(), part.sources.begin(), part.sources.end());
+				all.targets.insert(all.targets.end(), part.targets.begin(), part.targets.end());
+				all.weights.insert(all.weights.end(), part.weights.begin(), part.weights.end());
+				part.sources.clear();
+				part.targets.clear();
+				part.weights.clear();
+			}
+
+			carry = filled - complete;
+			std::memmove(buffer.data(), buffer.data() + complete, carry);
+		}
+		buffer = std::vector<char>();
+
+		std::vector<V> ids(all.sources);
+		ids.insert(ids.end(), all.targets.begin(), all.targets.end());
+		parallel::parallelSort(ids, std::less<V>(), pool);
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		std::vector<uint32_t> sources(all.sources.size()), targets(all.targets.size());
+		pool.parallelFor(sources.size(), [&](size_t begin, size_t end, size_t) {
+			for (size_t e = begin; e < end; ++e)
+			{
+				sources[e] = static_cast<uint32_t>(std::lower_bound(ids.begin(), ids.end(), all.sources[e]) - ids.begin());
+				targets[e] = static_cast<uint32_t>(std::lower_bound(ids.begin(), ids.end(), all.targets[e]) - ids.begin());
+			}
+		});
+		all.sources = std::vector<V>();
+		all.targets = std::vector<V>();
+
+		CSRGraph<W, V> csr = buildCSR<W, V>(std::move(ids), sources, targets, all.weights);
+		if (options.parallel_edges != ParallelEdges::Keep)
+		{
+			csr = detail::dropParallelEdges(std::move(csr), options.parallel_edges, pool);
+		}
+		return csr;
+	}
+
+	template <typename W = unsigned int, typename V = int>
+	CSRGraph<W, V> importEdgeList(const std::string& path, const EdgeListImportOptions& options = EdgeListImportOptions())
+	{
+		std::ifstream in(path, std::ios::binary);
+		if (!in)
+		{
+			throw std::runtime_error("Cannot open edge list " + path);
+		}
+		return importEdgeList<W, V>(in, options);
+	}
+} // namespace graph
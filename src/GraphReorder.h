@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "CSRGraph.h"
+
+namespace graph
+{
+	// Vertex numbering strategies that put nodes visited together next to each other in memory
+	enum class ReorderMethod
+	{
+		DegreeSort,			 // descending out-degree
+		BFS,				 // breadth-first discovery order, component by component
+		DFS,				 // depth-first preorder, component by component
+		ReverseCuthillMcKee, // bandwidth-reducing BFS from a low-degree node, neighbours by degree, reversed
+		HubCluster			 // nodes with above-average degree first, original order kept inside both groups
+	};
+
+	// Renumbered graph and the permutation that produced it. Per-node results computed on
+	// graph (indexed by new index) are mapped back with toOriginalOrder
+	template <typename W = unsigned int, typename V = int>
+	struct Reordering
+	{
+		template <typename T>
+		std::vector<T> toOriginalOrder(const std::vector<T>& values) const
+		{
+			std::vector<T> res(values.size());
+			for (size_t u = 0; u < values.size(); ++u)
+			{
+				res[new_to_old[u]] = values[u];
+			}
+			return res;
+		}
+
+		std::vector<uint32_t> new_to_old;
+		std::vector<uint32_t> old_to_new;
+		CSRGraph<W, V>		  graph;
+	};
+
+	namespace detail
+	{
+		// Visits every component, starting each at the first unvisited node of roots
+		template <typename W, typename V, typename Visit>
+		std::vector<uint32_t> traversalOrder(const CSRGraph<W, V>& g, const std::vector<uint32_t>& roots, Visit visit)
+		{
+			std::vector<bool>	  visited(g.getNodesCount(), false);
+			std::vector<uint32_t> order;
+			order.reserve(g.getNodesCount());
+			for (uint32_t root : roots)
+			{
+				if (!visited[root])
+				{
+					visit(root, visited, order);
+				}
+			}
+			return order;
+		}
+
+		inline std::vector<uint32_t> identityOrder(size_t n)
+		{
+			std::vector<uint32_t> order(n);
+			std::iota(order.begin(), order.end(), 0u);
+			return order;
+		}
+	} // namespace detail
+
+	// Returns new_to_old: position i holds the original index of the node numbered i
+	template <typename W, typename V>
+	std::vector<uint32_t> getOrdering(const CSRGraph<W, V>& g, ReorderMethod method)
+	{
+		size_t				  n = g.getNodesCount();
+		std::vector<uint32_t> order = detail::identityOrder(n);
+		auto				  degree = [&](uint32_t u) { return g.offsets[u + 1] - g.offsets[u]; };
+
+		switch (method)
+		{
+			case ReorderMethod::DegreeSort:
+				std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return degree(a) > degree(b); });
+				return order;
+
+			case ReorderMethod::HubCluster:
+			{
+				double average = n ? double(g.getEdgesCount()) / n : 0.0;
+				std::stable_partition(order.begin(), order.end(), [&](uint32_t u) { return degree(u) > average; });
+				return order;
+			}
+
+			case ReorderMethod::BFS:
+				return detail::traversalOrder(g, order, [&](uint32_t root, std::vector<bool>& visited, std::vector<uint32_t>& out) {
+					size_t head = out.size();
+					visited[root] = true;
+					out.push_back(root);
+					for (; head < out.size(); ++head)
+					{
+						g.forEachNeighbour(out[head], [&](uint32_t v, auto) {
+							if (!visited[v])
+							{
+								visited[v] = true;
+								out.push_back(v);
+							}
+						});
+					}
+				});
+
+			case ReorderMethod::DFS:
+				return detail::traversalOrder(g, order, [&](uint32_t root, std::vector<bool>& visited, std::vector<uint32_t>& out) {
+					std::vector<std::pair<uint32_t, size_t>> frames(1, std::make_pair(root, g.offsets[root]));
+					visited[root] = true;
+					out.push_back(root);
+					while (!frames.empty())
+					{
+						auto& [u, edge] = frames.back();
+						if (edge == g.offsets[u + 1])
+						{
+							frames.pop_back();
+							continue;
+						}
+						uint32_t v = g.targets[edge++];
+						if (!visited[v])
+						{
+							visited[v] = true;
+							out.push_back(v);
+							frames.emplace_back(v, g.offsets[v]);
+						}
+					}
+				});
+
+			case ReorderMethod::ReverseCuthillMcKee:
+			{
+				CSRGraph<W, V> sym = symmetrize(g);
+				auto		   sym_degree = [&](uint32_t u) { return sym.offsets[u + 1] - sym.offsets[u]; };
+
+				// each component starts from its lowest-degree node, a cheap pseudo-peripheral pick
+				std::vector<uint32_t> roots = order;
+				std::stable_sort(roots.begin(), roots.end(), [&](uint32_t a, uint32_t b) { return sym_degree(a) < sym_degree(b); });
+				std::vector<uint32_t> neighbours;
+				order = detail::traversalOrder(sym, roots, [&](uint32_t root, std::vector<bool>& visited, std::vector<uint32_t>& out) {
+					size_t head = out.size();
+					visited[root] = true;
+					out.push_back(root);
+					for (; head < out.size(); ++head)
+					{
+						neighbours.clear();
+						sym.forEachNeighbour(out[head], [&](uint32_t v, auto) {
+							if (!visited[v])
+							{
+								visited[v] = true;
+								neighbours.push_back(v);
+							}
+						});
+						std::stable_sort(neighbours.begin(), neighbours.end(), [&](uint32_t a, uint32_t b) { return sym_degree(a) < sym_degree(b); });
+						out.insert(out.end(), neighbours.begin(), neighbours.end());
+					}
+				});
+				std::reverse(order.begin(), order.end());
+				return order;
+			}
+		}
+		throw std::invalid_argument("Unknown reorder method");
+	}
+
+	// Renumbers g so that node new_to_old[i] becomes node i, adjacency order is preserved
+	template <typename W, typename V>
+	Reordering<W, V> permute(const CSRGraph<W, V>& g, std::vector<uint32_t> new_to_old)
+	{
+		size_t			 n = g.getNodesCount();
+		Reordering<W, V> res;
+		res.old_to_new.resize(n);
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			res.old_to_new[new_to_old[u]] = u;
+		}
+
+		CSRGraph<W, V>& out = res.graph;
+		out.offsets.assign(n + 1, 0);
+		out.targets.resize(g.getEdgesCount());
+		out.weights.resize(g.weights.size());
+		out.ids.resize(n);
+		out.index.reserve(n);
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			uint32_t old = new_to_old[u];
+			size_t	 begin = g.offsets[old], end = g.offsets[old + 1];
+			out.offsets[u + 1] = out.offsets[u] + (end - begin);
+			for (size_t e = begin, slot = out.offsets[u]; e < end; ++e, ++slot)
+			{
+				out.targets[slot] = res.old_to_new[g.targets[e]];
+				if (!g.weights.empty())
+				{
+					out.weights[slot] = g.weights[e];
+				}
+			}
+			out.ids[u] = g.ids[old];
+			out.index.emplace(out.ids[u], u);
+		}
+		res.new_to_old = std::move(new_to_old);
+		return res;
+	}
+
+	template <typename W, typename V>
+	Reordering<W, V> reorder(const CSRGraph<W, V>& g, ReorderMethod method)
+	{
+		return permute(g, getOrdering(g, method));
+	}
+} // namespace graph
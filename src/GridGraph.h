@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Traversal.h"
+
+namespace graph
+{
+	enum class GridConnectivity
+	{
+		Four, // orthogonal moves only
+		Eight // diagonal moves too, unless they would cut the corner of a blocked cell
+	};
+
+	// Implicit graph over a 2-D grid stored as one cost byte per cell; edges are generated on
+	// the fly. Cell (x, y) is node y * width + x, entering it costs its byte (times sqrt(2)
+	// for a diagonal move) and cost 0 marks it blocked. Exposes getNodesCount and
+	// forEachNeighbour, so the generic traversals and workspace searches run on it directly
+	class GridGraph
+	{
+	public:
+		using Weight = double;
+
+		static constexpr uint8_t blocked = 0;
+
+		GridGraph(uint32_t width, uint32_t height, GridConnectivity connectivity, uint8_t cost = 1)
+			: GridGraph(width, height, std::vector<uint8_t>(size_t(width) * height, cost), connectivity)
+		{
+		}
+
+		// cells holds width * height costs, row by row
+		GridGraph(uint32_t width, uint32_t height, std::vector<uint8_t> cells, GridConnectivity connectivity)
+			: width(width)
+			, height(height)
+			, connectivity(connectivity)
+			, cells(std::move(cells))
+		{
+			if (this->cells.size() != size_t(width) * height)
+			{
+				throw std::invalid_argument("Cell count does not match the grid size");
+			}
+			for (uint8_t cost : this->cells)
+			{
+				++histogram[cost];
+			}
+			updateMinCost();
+		}
+
+		uint32_t getWidth() const { return width; }
+		uint32_t getHeight() const { return height; }
+		size_t	 getNodesCount() const { return cells.size(); }
+		size_t	 getBytesCount() const { return cells.size(); }
+
+		GridConnectivity getConnectivity() const { return connectivity; }
+
+		uint32_t getIndex(uint32_t x, uint32_t y) const { return y * width + x; }
+
+		std::pair<uint32_t, uint32_t> getCell(uint32_t u) const { return std::make_pair(u % width, u / width); }
+
+		uint8_t getCost(uint32_t x, uint32_t y) const { return cells[getIndex(x, y)]; }
+
+		void setCost(uint32_t x, uint32_t y, uint8_t cost)
+		{
+			uint8_t& cell = cells[getIndex(x, y)];
+			--histogram[cell];
+			++histogram[cost];
+			cell = cost;
+			updateMinCost();
+		}
+
+		// False outside the grid
+		bool isPassable(int64_t x, int64_t y) const
+		{
+			return x >= 0 && y >= 0 && x < width && y < height && cells[size_t(y) * width + size_t(x)] != blocked;
+		}
+
+		// Lowest cost of a passable cell, 0 if every cell is blocked
+		uint8_t getMinCost() const { return min_cost; }
+
+		// All passable cells share one cost, the precondition of jump-point search
+		bool isUniform() const { return histogram[getMinCost()] + histogram[blocked] == cells.size(); }
+
+		// Manhattan (four) or octile (eight) distance times the lowest cell cost: admissible and
+		// consistent for the moves above
+		double getHeuristic(uint32_t u, uint32_t v) const
+		{
+			auto [ux, uy] = getCell(u);
+			auto [vx, vy] = getCell(v);
+			double dx = std::abs(double(ux) - vx), dy = std::abs(double(uy) - vy);
+			double steps = connectivity == GridConnectivity::Four ? dx + dy : std::max(dx, dy) + (std::sqrt(2.0) - 1) * std::min(dx, dy);
+			return steps * getMinCost();
+		}
+
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			static constexpr int dirs[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+			int64_t x = u % width, y = u / width;
+			size_t	count = connectivity == GridConnectivity::Four ? 4 : 8;
+			for (size_t d = 0; d < count; ++d)
+			{
+				int64_t nx = x + dirs[d][0], ny = y + dirs[d][1];
+				if (!isPassable(nx, ny) || (d >= 4 && !(isPassable(nx, y) && isPassable(x, ny))))
+				{
+					continue;
+				}
+				uint32_t v = uint32_t(ny * width + nx);
+				f(v, d < 4 ? double(cells[v]) : std::sqrt(2.0) * cells[v]);
+			}
+		}
+
+	private:
+		void updateMinCost()
+		{
+			min_cost = 0;
+			for (size_t cost = histogram.size() - 1; cost > 0; --cost)
+			{
+				min_cost = histogram[cost] ? uint8_t(cost) : min_cost;
+			}
+		}
+
+		uint32_t				width;
+		uint32_t				height;
+		GridConnectivity		connectivity;
+		std::vector<uint8_t>	cells;
+		std::array<size_t, 256> histogram {}; // cells per cost
+		uint8_t					min_cost = 0;
+	};
+
+	namespace detail
+	{
+		// Jump-point search successors (Harabor & Grastien) for eight-connected uniform grids
+		// without corner cutting: from u, reached from its parent, only the natural and forced
+		// directions are followed and each is scanned until a node with a forced neighbour,
+		// the goal or an obstacle
+		class JumpPoints
+		{
+		public:
+			JumpPoints(const GridGraph& grid, uint32_t goal)
+				: grid(grid)
+				, goal(grid.getCell(goal))
+			{
+			}
+
+			template <typename F>
+			void forEachSuccessor(uint32_t u, uint32_t parent, F&& f) const
+			{
+				auto [ux, uy] = grid.getCell(u);
+				int64_t x = ux, y = uy;
+				auto	open = [&](int64_t cx, int64_t cy) { return grid.isPassable(cx, cy); };
+
+				auto visit = [&](int64_t dx, int64_t dy) {
+					int64_t jx, jy;
+					if (jump(x + dx, y + dy, dx, dy, jx, jy))
+					{
+						f(grid.getIndex(uint32_t(jx), uint32_t(jy)));
+					}
+				};
+
+				if (u == parent)
+				{
+					for (int64_t dx = -1; dx <= 1; ++dx)
+					{
+						for (int64_t dy = -1; dy <= 1; ++dy)
+						{
+							if ((dx || dy) && open(x + dx, y + dy) && (!dx || !dy || (open(x + dx, y) && open(x, y + dy))))
+							{
+								visit(dx, dy);
+							}
+						}
+					}
+					return;
+				}
+
+				auto [px, py] = grid.getCell(parent);
+				int64_t dx = (x > px) - (x < px), dy = (y > py) - (y < py);
+				if (dx && dy)
+				{
+					bool vertical = open(x, y + dy), horizontal = open(x + dx, y);
+					if (vertical)
+					{
+						visit(0, dy);
+					}
+					if (horizontal)
+					{
+						visit(dx, 0);
+					}
+					if (vertical && horizontal)
+					{
+						visit(dx, dy);
+					}
+				}
+				else if (dx)
+				{
+					bool next = open(x + dx, y), up = open(x, y + 1), down = open(x, y - 1);
+					if (next)
+					{
+						visit(dx, 0);
+						if (up)
+						{
+							visit(dx, 1);
+						}
+						if (down)
+						{
+							visit(dx, -1);
+						}
+					}
+					if (up)
+					{
+						visit(0, 1);
+					}
+					if (down)
+					{
+						visit(0, -1);
+					}
+				}
+				else
+				{
+					bool next = open(x, y + dy), right = open(x + 1, y), left = open(x - 1, y);
+					if (next)
+					{
+						visit(0, dy);
+						if (right)
+						{
+							visit(1, dy);
+						}
+						if (left)
+						{
+							visit(-1, dy);
+						}
+					}
+					if (right)
+					{
+						visit(1, 0);
+					}
+					if (left)
+					{
+						visit(-1, 0);
+					}
+				}
+			}
+
+		private:
+			// A neighbour beside the move is open while the cell behind it is blocked, so the
+			// only optimal way there runs through (x, y)
+			bool isForced(int64_t x, int64_t y, int64_t dx, int64_t dy) const
+			{
+				auto open = [&](int64_t cx, int64_t cy) { return grid.isPassable(cx, cy); };
+				if (dx)
+				{
+					return (open(x, y - 1) && !open(x - dx, y - 1)) || (open(x, y + 1) && !open(x - dx, y + 1));
+				}
+				return (open(x - 1, y) && !open(x - 1, y - dy)) || (open(x + 1, y) && !open(x + 1, y - dy));
+			}
+
+			bool scanStraight(int64_t x, int64_t y, int64_t dx, int64_t dy, int64_t& jx, int64_t& jy) const
+			{
+				for (; grid.isPassable(x, y); x += dx, y += dy)
+				{
+					if (isGoal(x, y) || isForced(x, y, dx, dy))
+					{
+						jx = x;
+						jy = y;
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// Scan from (x, y), the first cell in direction (dx, dy), and write the jump point found
+			bool jump(int64_t x, int64_t y, int64_t dx, int64_t dy, int64_t& jx, int64_t& jy) const
+			{
+				if (!dx || !dy)
+				{
+					return scanStraight(x, y, dx, dy, jx, jy);
+				}
+
+				// diagonal: stop where a straight scan along either component finds something
+				int64_t sx, sy;
+				while (grid.isPassable(x, y))
+				{
+					if (isGoal(x, y) || scanStraight(x + dx, y, dx, 0, sx, sy) || scanStraight(x, y + dy, 0, dy, sx, sy))
+					{
+						jx = x;
+						jy = y;
+						return true;
+					}
+					if (!(grid.isPassable(x + dx, y) && grid.isPassable(x, y + dy)))
+					{
+						return false;
+					}
+					x += dx;
+					y += dy;
+				}
+				return false;
+			}
+
+			bool isGoal(int64_t x, int64_t y) const { return x == goal.first && y == goal.second; }
+
+			const GridGraph&			  grid;
+			std::pair<uint32_t, uint32_t> goal;
+		};
+	} // namespace detail
+
+	// A* between two cells with the grid heuristic; ws is reused across queries so repeated
+	// searches allocate nothing. With jump_points on an eight-connected grid whose passable
+	// cells all cost the same, jump-point search expands only jump points and the straight or
+	// diagonal runs between them are filled in afterwards; on other grids plain A* is used.
+	// Returns the cells from "from" to "to" inclusive and the cost, or an empty path and the
+	// maximum double
+	inline std::pair<std::vector<uint32_t>, double> findPath(uint32_t from, uint32_t to, const GridGraph& grid, TraversalWorkspace<double>& ws, bool jump_points = false)
+	{
+		std::pair<std::vector<uint32_t>, double> res(std::vector<uint32_t>(), std::numeric_limits<double>::max());
+		if (!grid.isPassable(grid.getCell(from).first, grid.getCell(from).second) || !grid.isPassable(grid.getCell(to).first, grid.getCell(to).second))
+		{
+			return res;
+		}
+
+		bool									  jps = jump_points && grid.getConnectivity() == GridConnectivity::Eight && grid.isUniform();
+		detail::JumpPoints						  successors(grid, to);
+		std::greater<std::pair<double, uint32_t>> later;
+
+		ws.start(grid.getNodesCount());
+		ws.source = from;
+		ws.reach(from, 0.0, from);
+		ws.heap.emplace_back(grid.getHeuristic(from, to), from);
+		auto relax = [&](uint32_t u, uint32_t v, double cost) {
+			double g = ws.getDist(u) + cost;
+			if (g < ws.getDist(v))
+			{
+				ws.reach(v, g, u);
+				ws.heap.emplace_back(g + grid.getHeuristic(v, to), v);
+				std::push_heap(ws.heap.begin(), ws.heap.end(), later);
+			}
+		};
+
+		while (!ws.heap.empty())
+		{
+			std::pop_heap(ws.heap.begin(), ws.heap.end(), later);
+			uint32_t u = ws.heap.back().second;
+			ws.heap.pop_back();
+			if (ws.isDone(u))
+			{
+				continue;
+			}
+			ws.markDone(u);
+			if (u == to)
+			{
+				break;
+			}
+			if (jps)
+			{
+				// on a uniform grid the heuristic is the exact cost of a straight or diagonal jump
+				successors.forEachSuccessor(u, ws.getParent(u), [&](uint32_t v) { relax(u, v, grid.getHeuristic(u, v)); });
+			}
+			else
+			{
+				grid.forEachNeighbour(u, [&](uint32_t v, double cost) { relax(u, v, cost); });
+			}
+		}
+		if (!ws.isDone(to))
+		{
+			return res;
+		}
+
+		std::vector<uint32_t> waypoints = ws.getPath(to);
+		res.first.push_back(from);
+		for (size_t i = 1; i < waypoints.size(); ++i)
+		{
+			auto [x, y] = grid.getCell(waypoints[i - 1]);
+			auto [tx, ty] = grid.getCell(waypoints[i]);
+			while (x != tx || y != ty)
+			{
+				x += (x < tx) - (x > tx);
+				y += (y < ty) - (y > ty);
+				res.first.push_back(grid.getIndex(x, y));
+			}
+		}
+		res.second = ws.getDist(to);
+		return res;
+	}
+
+	inline std::pair<std::vector<uint32_t>, double> findPath(uint32_t from, uint32_t to, const GridGraph& grid, bool jump_points = false)
+	{
+		TraversalWorkspace<double> ws;
+		return findPath(from, to, grid, ws, jump_points);
+	}
+} // namespace graph
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "Graph.h"
+
+namespace graph
+{
+	// Keeps shortest-path trees of registered sources up to date while edges are inserted or
+	// made lighter. An update only walks the nodes whose cost actually drops: it seeds a heap
+	// with the head of the changed edge and relaxes outwards while costs keep improving.
+	// The graph must be modified through this class, direct addEdge calls leave trees stale
+	template <typename W = unsigned int, typename V = int>
+	class IncrementalShortestPaths
+	{
+	public:
+		explicit IncrementalShortestPaths(WGraph<W, V>& g)
+			: graph(g)
+		{
+		}
+
+		// Computes the initial tree with a full run, a source already registered is kept as is
+		void addSource(V source)
+		{
+			if (trees.find(source) == trees.end())
+			{
+				trees.emplace(source, getShortestPathTree(source, graph));
+			}
+		}
+
+		void removeSource(V source) { trees.erase(source); }
+
+		bool hasSource(V source) const { return trees.find(source) != trees.end(); }
+
+		const ShortestPathTree<W, V>& getTree(V source) const
+		{
+			auto it = trees.find(source);
+			if (it == trees.end())
+			{
+				throw std::out_of_range("Source is not registered");
+			}
+			return it->second;
+		}
+
+		// Inserts the edge and repairs every tree, returns how many (source, node) costs dropped.
+		// An edge closing a negative cycle is rejected with the graph and all trees unchanged
+		size_t addEdge(V from, V to, W weight)
+		{
+			auto changes = findChanges(from, to, weight);
+			graph.addEdge(from, to, weight);
+			return apply(changes);
+		}
+
+		// Lowers the lightest from -> to edge to weight; raising a weight is not supported since
+		// it can lengthen paths, which needs a decremental algorithm
+		size_t decreaseWeight(V from, V to, W weight)
+		{
+			auto lightest = findLightest(graph.edges_to, from, to);
+			if (lightest == graph.edges_to.end())
+			{
+				throw std::invalid_argument("Edge is not in the graph");
+			}
+			if (weight > lightest->second.first)
+			{
+				throw std::invalid_argument("Only weight decreases can be repaired incrementally");
+			}
+			auto changes = findChanges(from, to, weight);
+			lightest->second.first = weight;
+			findLightest(graph.edges_from, to, from)->second.first = weight;
+			++graph.version;
+			return apply(changes);
+		}
+
+		// Nodes whose cost dropped during the last addEdge or decreaseWeight, over all sources
+		size_t getLastUpdatedCount() const { return last_updated; }
+
+	private:
+		using EdgesArray = typename WGraph<W, V>::EdgesArray;
+
+		static typename EdgesArray::iterator findLightest(EdgesArray& edges, V from, V to)
+		{
+			auto range = edges.equal_range(from);
+			auto res = edges.end();
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (it->second.second == to && (res == edges.end() || it->second.first < res->second.first))
+				{
+					res = it;
+				}
+			}
+			return res;
+		}
+
+		struct Update
+		{
+			W cost;
+			V parent;
+		};
+
+		using Changes = std::vector<std::pair<ShortestPathTree<W, V>*, std::unordered_map<V, Update>>>;
+
+		// Computes the repair of every tree without touching trees or graph, so a negative
+		// cycle found in any of them leaves everything as it was
+		Changes findChanges(V from, V to, W weight)
+		{
+			if (from == to && weight < W(0))
+			{
+				throw std::runtime_error("Graph contains negative weight cycle");
+			}
+			Changes changes;
+			for (auto& [source, tree] : trees)
+			{
+				auto updates = findChanges(tree, from, to, weight);
+				if (!updates.empty())
+				{
+					changes.emplace_back(&tree, std::move(updates));
+				}
+			}
+			return changes;
+		}
+
+		size_t apply(const Changes& changes)
+		{
+			last_updated = 0;
+			for (auto& [tree, updates] : changes)
+			{
+				for (auto& [node, update] : updates)
+				{
+					tree->costs[node] = update.cost;
+					tree->parents[node] = update.parent;
+				}
+				last_updated += updates.size();
+			}
+			return last_updated;
+		}
+
+		// Label-correcting propagation from "to"; also valid for negative weights as long as
+		// the new edge closes no negative cycle, which shows up as the cost of "from" dropping.
+		// The new edge itself need not be in the graph yet: reaching "from" again is an error
+		std::unordered_map<V, Update> findChanges(const ShortestPathTree<W, V>& tree, V from, V to, W weight)
+		{
+			std::unordered_map<V, Update> updates;
+			auto cost_of = [&](V node) {
+				auto it = updates.find(node);
+				return it == updates.end() ? tree.getCost(node) : it->second.cost;
+			};
+
+			W from_cost = tree.getCost(from);
+			if (from_cost == std::numeric_limits<W>::max() || from_cost + weight >= tree.getCost(to))
+			{
+				return updates;
+			}
+			updates[to] = { W(from_cost + weight), from };
+
+			std::priority_queue<std::pair<W, V>, std::vector<std::pair<W, V>>, std::greater<std::pair<W, V>>> heap;
+			heap.push(std::make_pair(from_cost + weight, to));
+			while (!heap.empty())
+			{
+				auto top = heap.top();
+				heap.pop();
+				if (top.first > cost_of(top.second))
+				{
+					continue;
+				}
+				auto range = graph.edges_to.equal_range(top.second);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					W new_cost = top.first + it->second.first;
+					V next = it->second.second;
+					if (new_cost < cost_of(next))
+					{
+						if (next == from)
+						{
+							throw std::runtime_error("Graph contains negative weight cycle");
+						}
+						updates[next] = { new_cost, top.second };
+						heap.push(std::make_pair(new_cost, next));
+					}
+				}
+			}
+			return updates;
+		}
+
+		WGraph<W, V>&								  graph;
+		std::unordered_map<V, ShortestPathTree<W, V>> trees;
+		size_t										  last_updated = 0;
+	};
+} // namespace graph
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+
+namespace graph
+{
+	struct CompactionOptions
+	{
+		size_t max_log_edges = size_t(1) << 20; // compact once the log holds this many edges
+		double max_log_ratio = 0.25;			// or this fraction of the base's edges, whichever comes first
+		size_t min_log_edges = 1024;			// never compact smaller logs, whatever the ratio
+		bool   background = true;				// merge on a separate thread while inserts continue
+	};
+
+	// Mutable graph in two layers, like a log-structured merge tree: a compacted CSR base and
+	// an append-only log of the edges added since. Log entries of one source are chained in
+	// insertion order, so an insert is O(1) and listing a node's log edges costs only their
+	// number. When the log passes the configured thresholds it is frozen and merged into a new
+	// base, on a background thread if requested, while new edges go to a fresh log; the merged
+	// base is swapped in by the next addEdge (or compact / waitForCompaction), never during a
+	// read. Reads see base, frozen log and log in insertion order. Single writer; the graph
+	// may be read from other threads only while nobody writes
+	template <typename W = unsigned int, typename V = int>
+	class LSMGraph
+	{
+	public:
+		using Weight = W;
+		using Vertex = V;
+
+		explicit LSMGraph(const WGraph<W, V>& initial = WGraph<W, V>(), CompactionOptions options = CompactionOptions())
+			: options(options)
+			, base(std::make_shared<const CSRGraph<W, V>>(toCSR(initial)))
+			, log(std::make_shared<Log>())
+		{
+			ids = base->ids;
+			index = base->index;
+			edges = base->getEdgesCount();
+		}
+
+		~LSMGraph()
+		{
+			if (merging.valid())
+			{
+				merging.wait();
+			}
+		}
+
+		LSMGraph(const LSMGraph&) = delete;
+		LSMGraph& operator=(const LSMGraph&) = delete;
+
+		void addEdge(V from, V to, W weight)
+		{
+			installIfReady();
+			uint32_t source = addNode(from), target = addNode(to);
+			log->append(source, target, weight);
+			++edges;
+			if (!merging.valid() && shouldCompact())
+			{
+				startCompaction();
+			}
+		}
+
+		size_t getNodesCount() const { return ids.size(); }
+
+		size_t getEdgesCount() const { return edges; }
+
+		// Edges not yet merged into the base, frozen log included
+		size_t getLogEdgesCount() const { return log->size() + (frozen ? frozen->size() : 0); }
+
+		size_t getCompactionsCount() const { return compactions; }
+
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			if (u < base->getNodesCount())
+			{
+				base->forEachNeighbour(u, f);
+			}
+			if (frozen)
+			{
+				frozen->forEach(u, f);
+			}
+			log->forEach(u, f);
+		}
+
+		uint32_t getIndex(V node) const
+		{
+			auto it = index.find(node);
+			if (it == index.end())
+			{
+				throw std::out_of_range("Node is not in the graph");
+			}
+			return it->second;
+		}
+
+		V getId(uint32_t u) const { return ids[u]; }
+
+		// Merges everything into the base before returning
+		void compact()
+		{
+			waitForCompaction();
+			if (log->size())
+			{
+				startCompaction(false);
+			}
+		}
+
+		// Blocks until a running background merge is installed
+		void waitForCompaction()
+		{
+			if (merging.valid())
+			{
+				install(merging.get());
+			}
+		}
+
+	private:
+		// Append-only edge log with per-source chains in insertion order
+		class Log
+		{
+		public:
+			static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+			size_t size() const { return entries.size(); }
+
+			void append(uint32_t source, uint32_t target, W weight)
+			{
+				if (heads.size() <= source)
+				{
+					heads.resize(source + 1, none);
+					tails.resize(source + 1, none);
+				}
+				uint32_t e = uint32_t(entries.size());
+				entries.push_back({ target, none, weight });
+				(tails[source] == none ? heads[source] : entries[tails[source]].next) = e;
+				tails[source] = e;
+			}
+
+			template <typename F>
+			void forEach(uint32_t u, F& f) const
+			{
+				for (uint32_t e = u < heads.size() ? heads[u] : none; e != none; e = entries[e].next)
+				{
+					f(entries[e].target, entries[e].weight);
+				}
+			}
+
+		private:
+			struct Entry
+			{
+				uint32_t target;
+				uint32_t next;
+				W		 weight;
+			};
+
+			std::vector<uint32_t> heads;
+			std::vector<uint32_t> tails;
+			std::vector<Entry>	  entries;
+		};
+
+		uint32_t addNode(V node)
+		{
+			auto [it, inserted] = index.emplace(node, uint32_t(ids.size()));
+			if (inserted)
+			{
+				ids.push_back(node);
+			}
+			return it->second;
+		}
+
+		bool shouldCompact() const
+		{
+			size_t size = log->size();
+			return size >= options.min_log_edges && (size >= options.max_log_edges || double(size) >= options.max_log_ratio * double(base->getEdgesCount()));
+		}
+
+		// Freezes the log and merges base + frozen log into a new base over the current nodes
+		void startCompaction(bool background = true)
+		{
+			frozen = std::move(log);
+			log = std::make_shared<Log>();
+			std::shared_ptr<const CSRGraph<W, V>> old_base = base;
+			std::shared_ptr<const Log>			  old_log = frozen;
+			std::vector<V>						  new_ids = ids;
+
+			auto merge = [old_base, old_log, new_ids = std::move(new_ids)]() mutable {
+				size_t				  m = old_base->getEdgesCount() + old_log->size();
+				std::vector<uint32_t> sources, targets;
+				std::vector<W>		  weights;
+				sources.reserve(m);
+				targets.reserve(m);
+				weights.reserve(m);
+				for (uint32_t u = 0; u < new_ids.size(); ++u)
+				{
+					auto add = [&](uint32_t v, W weight) {
+						sources.push_back(u);
+						targets.push_back(v);
+						weights.push_back(weight);
+					};
+					if (u < old_base->getNodesCount())
+					{
+						old_base->forEachNeighbour(u, add);
+					}
+					old_log->forEach(u, add);
+				}
+				return std::make_shared<const CSRGraph<W, V>>(buildCSR<W, V>(std::move(new_ids), sources, targets, weights));
+			};
+
+			if (background && options.background)
+			{
+				merging = std::async(std::launch::async, std::move(merge));
+			}
+			else
+			{
+				install(merge());
+			}
+		}
+
+		void installIfReady()
+		{
+			if (merging.valid() && merging.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				install(merging.get());
+			}
+		}
+
+		void install(std::shared_ptr<const CSRGraph<W, V>> merged)
+		{
+			base = std::move(merged);
+			frozen.reset();
+			++compactions;
+		}
+
+		CompactionOptions								   options;
+		std::shared_ptr<const CSRGraph<W, V>>			   base;
+		std::shared_ptr<const Log>						   frozen; // being merged into the next base
+		std::shared_ptr<Log>							   log;
+		std::future<std::shared_ptr<const CSRGraph<W, V>>> merging;
+		std::vector<V>									   ids;
+		std::unordered_map<V, uint32_t>					   index;
+		size_t											   edges = 0;
+		size_t											   compactions = 0;
+	};
+} // namespace graph
@@ -0,0 +1,610 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+namespace graph
+{
+	// Residual graph in CSR form: every edge u -> v of capacity c becomes the arc u -> v with
+	// residual c and the paired arc v -> u with residual 0, reverse[a] links the two. The
+	// algorithms below update capacity in place; reset() restores the original network
+	template <typename W = unsigned int>
+	struct FlowNetwork
+	{
+		size_t getNodesCount() const { return offsets.size() - 1; }
+
+		size_t getArcsCount() const { return targets.size(); }
+
+		// Flow currently sent along an arc, 0 for the paired reverse arcs
+		W getFlow(size_t arc) const { return original[arc] > capacity[arc] ? original[arc] - capacity[arc] : W(0); }
+
+		void reset() { capacity = original; }
+
+		std::vector<size_t>	  offsets;
+		std::vector<uint32_t> targets;
+		std::vector<size_t>	  reverse;
+		std::vector<W>		  capacity;
+		std::vector<W>		  original;
+	};
+
+	// Capacities are the edge weights; self-loops are dropped, parallel edges kept
+	template <typename W, typename V>
+	FlowNetwork<W> buildFlowNetwork(const CSRGraph<W, V>& g)
+	{
+		size_t		   n = g.getNodesCount();
+		FlowNetwork<W> net;
+		net.offsets.assign(n + 1, 0);
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			g.forEachNeighbour(u, [&](uint32_t v, W c) {
+				if (c < W(0))
+				{
+					throw std::invalid_argument("Capacities must be non-negative");
+				}
+				if (u != v)
+				{
+					++net.offsets[u + 1];
+					++net.offsets[v + 1];
+				}
+			});
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			net.offsets[i + 1] += net.offsets[i];
+		}
+
+		std::vector<size_t> cursor(net.offsets.begin(), net.offsets.end() - 1);
+		size_t				m = net.offsets[n];
+		net.targets.resize(m);
+		net.reverse.resize(m);
+		net.original.resize(m);
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			g.forEachNeighbour(u, [&](uint32_t v, W c) {
+				if (u == v)
+				{
+					return;
+				}
+				size_t forward = cursor[u]++, backward = cursor[v]++;
+				net.targets[forward] = v;
+				net.targets[backward] = u;
+				net.reverse[forward] = backward;
+				net.reverse[backward] = forward;
+				net.original[forward] = c;
+				net.original[backward] = W(0);
+			});
+		}
+		net.capacity = net.original;
+		return net;
+	}
+
+	// Maximum flow value plus the minimum cut with the largest source side: the nodes that
+	// cannot reach the sink in the final residual graph. That side is the same whichever
+	// algorithm computed the flow
+	template <typename W = unsigned int, typename V = int>
+	struct FlowResult
+	{
+		struct Edge
+		{
+			V from;
+			V to;
+			W capacity;
+		};
+
+		bool isOnSourceSide(V node) const { return source_side[index.at(node)]; }
+
+		W								value = 0;
+		std::vector<bool>				source_side; // dense, by index of ids
+		std::vector<Edge>				cut_edges;	 // saturated edges from the source to the sink side
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	enum class FlowAlgorithm
+	{
+		Dinic,				// blocking flows on BFS level graphs, good on unit-capacity and sparse networks
+		PushRelabel,		// highest-label push-relabel with global relabel and gap heuristics
+		ParallelPushRelabel // synchronous pulses of push and relabel phases across a thread pool
+	};
+
+	namespace detail
+	{
+		constexpr uint32_t unlabeled = std::numeric_limits<uint32_t>::max();
+
+		// Distance to the sink over residual arcs, n where the sink is unreachable
+		template <typename W>
+		void sinkDistances(const FlowNetwork<W>& net, uint32_t sink, std::vector<uint32_t>& dist)
+		{
+			uint32_t n = static_cast<uint32_t>(net.getNodesCount());
+			dist.assign(n, unlabeled);
+			std::vector<uint32_t> fifo(1, sink);
+			dist[sink] = 0;
+			for (size_t head = 0; head < fifo.size(); ++head)
+			{
+				uint32_t w = fifo[head];
+				for (size_t a = net.offsets[w]; a < net.offsets[w + 1]; ++a)
+				{
+					uint32_t u = net.targets[a];
+					if (dist[u] == unlabeled && net.capacity[net.reverse[a]] > W(0))
+					{
+						dist[u] = dist[w] + 1;
+						fifo.push_back(u);
+					}
+				}
+			}
+			std::replace(dist.begin(), dist.end(), unlabeled, n);
+		}
+
+		template <typename W, typename V>
+		FlowResult<W, V> makeFlowResult(const CSRGraph<W, V>& g, const FlowNetwork<W>& net, uint32_t sink, W value)
+		{
+			FlowResult<W, V>	  res;
+			std::vector<uint32_t> dist;
+			sinkDistances(net, sink, dist);
+			uint32_t n = static_cast<uint32_t>(net.getNodesCount());
+			res.value = value;
+			res.source_side.resize(n);
+			for (uint32_t u = 0; u < n; ++u)
+			{
+				res.source_side[u] = dist[u] == n;
+			}
+			for (uint32_t u = 0; u < n; ++u)
+			{
+				for (size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a)
+				{
+					uint32_t v = net.targets[a];
+					if (res.source_side[u] && !res.source_side[v] && net.original[a] > W(0))
+					{
+						res.cut_edges.push_back({ g.ids[u], g.ids[v], net.original[a] });
+					}
+				}
+			}
+			res.ids = g.ids;
+			res.index = g.index;
+			return res;
+		}
+	} // namespace detail
+
+	// Dinic: BFS levels from the source, then blocking flow by iterative DFS along level-
+	// increasing arcs with per-node current-arc pointers, repeated until the sink is cut off
+	template <typename W>
+	W Dinic(FlowNetwork<W>& net, uint32_t source, uint32_t sink)
+	{
+		size_t				  n = net.getNodesCount();
+		std::vector<uint32_t> level(n), fifo;
+		std::vector<size_t>	  current(n), path;
+		W					  total = 0;
+		if (source == sink)
+		{
+			return total;
+		}
+		for (;;)
+		{
+			std::fill(level.begin(), level.end(), detail::unlabeled);
+			fifo.assign(1, source);
+			level[source] = 0;
+			for (size_t head = 0; head < fifo.size() && level[sink] == detail::unlabeled; ++head)
+			{
+				uint32_t u = fifo[head];
+				for (size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a)
+				{
+					uint32_t v = net.targets[a];
+					if (level[v] == detail::unlabeled && net.capacity[a] > W(0))
+					{
+						level[v] = level[u] + 1;
+						fifo.push_back(v);
+					}
+				}
+			}
+			if (level[sink] == detail::unlabeled)
+			{
+				return total;
+			}
+
+			std::copy(net.offsets.begin(), net.offsets.end() - 1, current.begin());
+			path.clear();
+			uint32_t u = source;
+			for (;;)
+			{
+				if (u == sink)
+				{
+					W pushed = net.capacity[path.front()];
+					for (size_t a : path)
+					{
+						pushed = std::min(pushed, net.capacity[a]);
+					}
+					for (size_t a : path)
+					{
+						net.capacity[a] -= pushed;
+						net.capacity[net.reverse[a]] += pushed;
+					}
+					total += pushed;
+					path.clear();
+					u = source;
+					continue;
+				}
+
+				size_t& a = current[u];
+				while (a < net.offsets[u + 1] && !(net.capacity[a] > W(0) && level[net.targets[a]] == level[u] + 1))
+				{
+					++a;
+				}
+				if (a < net.offsets[u + 1])
+				{
+					path.push_back(a);
+					u = net.targets[a];
+					continue;
+				}
+
+				// dead end: drop u from the level graph and retreat past the arc that led here
+				level[u] = detail::unlabeled;
+				if (path.empty())
+				{
+					break;
+				}
+				u = net.targets[net.reverse[path.back()]];
+				path.pop_back();
+				++current[u];
+			}
+		}
+	}
+
+	// Highest-label push-relabel, first phase only (a maximum preflow, whose sink excess is
+	// the maximum flow value). Active nodes sit in per-label buckets and the highest one is
+	// discharged first. Labels are recomputed exactly by a backward BFS from the sink after
+	// every O(n + m) units of work (global relabel), and when a label empties every node above
+	// it is cut off from the sink (gap heuristic)
+	template <typename W>
+	W PushRelabel(FlowNetwork<W>& net, uint32_t source, uint32_t sink)
+	{
+		uint32_t n = static_cast<uint32_t>(net.getNodesCount());
+		if (source == sink)
+		{
+			return W(0);
+		}
+
+		std::vector<uint32_t>			   label, count;
+		std::vector<W>					   excess(n, W(0));
+		std::vector<size_t>				   current(net.offsets.begin(), net.offsets.end() - 1);
+		std::vector<std::vector<uint32_t>> buckets(n);
+		uint32_t						   highest = 0;
+
+		auto activate = [&](uint32_t v) {
+			if (v != source && v != sink && label[v] < n)
+			{
+				buckets[label[v]].push_back(v);
+				highest = std::max(highest, label[v]);
+			}
+		};
+
+		auto globalRelabel = [&]() {
+			detail::sinkDistances(net, sink, label);
+			label[source] = n;
+			count.assign(n + 1, 0);
+			for (uint32_t u = 0; u < n; ++u)
+			{
+				++count[label[u]];
+			}
+			for (auto& bucket : buckets)
+			{
+				bucket.clear();
+			}
+			highest = 0;
+			for (uint32_t u = 0; u < n; ++u)
+			{
+				current[u] = net.offsets[u];
+				if (excess[u] > W(0))
+				{
+					activate(u);
+				}
+			}
+		};
+
+		for (size_t a = net.offsets[source]; a < net.offsets[source + 1]; ++a)
+		{
+			W c = net.capacity[a];
+			net.capacity[a] -= c;
+			net.capacity[net.reverse[a]] += c;
+			excess[net.targets[a]] += c;
+		}
+		globalRelabel();
+
+		size_t work = 0, relabel_period = 6 * size_t(n) + net.getArcsCount();
+		for (;;)
+		{
+			while (highest > 0 && buckets[highest].empty())
+			{
+				--highest;
+			}
+			if (buckets[highest].empty())
+			{
+				break;
+			}
+			uint32_t v = buckets[highest].back();
+			buckets[highest].pop_back();
+			if (label[v] != highest || !(excess[v] > W(0)))
+			{
+				continue;
+			}
+
+			// discharge v
+			while (excess[v] > W(0) && label[v] < n)
+			{
+				size_t& a = current[v];
+				if (a == net.offsets[v + 1])
+				{
+					uint32_t old = label[v], lowest = n;
+					for (size_t b = net.offsets[v]; b < net.offsets[v + 1]; ++b)
+					{
+						if (net.capacity[b] > W(0))
+						{
+							lowest = std::min(lowest, label[net.targets[b]] + 1);
+						}
+					}
+					work += net.offsets[v + 1] - net.offsets[v] + 12;
+					--count[old];
+					label[v] = std::min(lowest, n);
+					++count[label[v]];
+					a = net.offsets[v];
+					if (count[old] == 0)
+					{
+						for (uint32_t u = 0; u < n; ++u)
+						{
+							if (label[u] > old && label[u] < n)
+							{
+								--count[label[u]];
+								label[u] = n;
+								++count[n];
+							}
+						}
+					}
+					continue;
+				}
+
+				uint32_t w = net.targets[a];
+				if (net.capacity[a] > W(0) && label[v] == label[w] + 1)
+				{
+					W	 delta = std::min(excess[v], net.capacity[a]);
+					bool was_idle = !(excess[w] > W(0));
+					net.capacity[a] -= delta;
+					net.capacity[net.reverse[a]] += delta;
+					excess[v] -= delta;
+					excess[w] += delta;
+					if (was_idle)
+					{
+						activate(w);
+					}
+				}
+				if (excess[v] > W(0))
+				{
+					++a;
+				}
+			}
+
+			if (work > relabel_period)
+			{
+				work = 0;
+				globalRelabel();
+			}
+		}
+		return excess[sink];
+	}
+
+	// Synchronous parallel push-relabel (first phase). Every pulse runs three barriered phases
+	// over the active nodes: push along admissible arcs using the labels of the previous
+	// pulse, relabel the nodes still holding excess from the now settled capacities, then
+	// apply the new labels and the excess received. Two ends of an arc can never both see it
+	// admissible in one pulse, so each residual capacity has a single writer and only the
+	// incoming excess needs atomics. The gap heuristic is replaced by a parallel global
+	// relabel whenever the pulse relabels add up to n
+	template <typename W>
+	W ParallelPushRelabel(FlowNetwork<W>& net, uint32_t source, uint32_t sink, parallel::ThreadPool& pool)
+	{
+		uint32_t n = static_cast<uint32_t>(net.getNodesCount());
+		if (source == sink)
+		{
+			return W(0);
+		}
+
+		size_t							   workers = pool.getThreadsCount();
+		std::vector<uint32_t>			   label(n, 0), pending(n);
+		std::vector<W>					   excess(n, W(0));
+		std::vector<std::atomic<W>>		   incoming(n);
+		std::vector<std::atomic<uint8_t>>  queued(n);
+		std::vector<size_t>				   current(net.offsets.begin(), net.offsets.end() - 1);
+		std::vector<uint32_t>			   active, relabeled;
+		std::vector<std::vector<uint32_t>> next_active(workers), next_relabeled(workers);
+		std::vector<std::atomic<uint32_t>> dist(n);
+
+		auto gather = [](std::vector<std::vector<uint32_t>>& parts, std::vector<uint32_t>& out) {
+			out.clear();
+			for (auto& part : parts)
+			{
+				out.insert(out.end(), part.begin(), part.end());
+				part.clear();
+			}
+		};
+
+		// level-synchronous backward BFS from the sink, nodes claimed by CAS
+		auto globalRelabel = [&]() {
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				for (size_t u = begin; u < end; ++u)
+				{
+					dist[u].store(n, std::memory_order_relaxed);
+				}
+			});
+			dist[sink].store(0, std::memory_order_relaxed);
+			std::vector<uint32_t> frontier(1, sink);
+			for (uint32_t level = 1; !frontier.empty(); ++level)
+			{
+				pool.parallelFor(frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+					for (size_t i = begin; i < end; ++i)
+					{
+						uint32_t w = frontier[i];
+						for (size_t a = net.offsets[w]; a < net.offsets[w + 1]; ++a)
+						{
+							uint32_t u = net.targets[a], unreached = n;
+							if (u != source && net.capacity[net.reverse[a]] > W(0) && dist[u].load(std::memory_order_relaxed) == n &&
+								dist[u].compare_exchange_strong(unreached, level, std::memory_order_relaxed))
+							{
+								next_active[worker].push_back(u);
+							}
+						}
+					}
+				});
+				gather(next_active, frontier);
+			}
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				for (size_t u = begin; u < end; ++u)
+				{
+					label[u] = dist[u].load(std::memory_order_relaxed);
+					current[u] = net.offsets[u];
+				}
+			});
+			label[source] = n;
+		};
+
+		auto enqueue = [&](uint32_t v, size_t worker) {
+			uint8_t idle = 0;
+			if (v != source && v != sink && queued[v].compare_exchange_strong(idle, 1, std::memory_order_relaxed))
+			{
+				next_active[worker].push_back(v);
+			}
+		};
+
+		for (size_t a = net.offsets[source]; a < net.offsets[source + 1]; ++a)
+		{
+			W c = net.capacity[a];
+			net.capacity[a] -= c;
+			net.capacity[net.reverse[a]] += c;
+			excess[net.targets[a]] += c;
+		}
+		globalRelabel();
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			if (u != source && u != sink && excess[u] > W(0) && label[u] < n)
+			{
+				active.push_back(u);
+			}
+		}
+
+		size_t relabels = 0;
+		while (!active.empty())
+		{
+			pool.parallelFor(active.size(), [&](size_t begin, size_t end, size_t worker) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					uint32_t v = active[i];
+					W		 left = excess[v];
+					for (size_t& a = current[v]; a < net.offsets[v + 1] && left > W(0); ++a)
+					{
+						uint32_t w = net.targets[a];
+						if (label[v] == label[w] + 1 && net.capacity[a] > W(0))
+						{
+							W delta = std::min(left, net.capacity[a]);
+							net.capacity[a] -= delta;
+							net.capacity[net.reverse[a]] += delta;
+							left -= delta;
+							incoming[w].fetch_add(delta, std::memory_order_relaxed);
+							enqueue(w, worker);
+							if (!(left > W(0)))
+							{
+								break; // the arc may still have room, keep it current
+							}
+						}
+					}
+					excess[v] = left;
+					if (left > W(0))
+					{
+						next_relabeled[worker].push_back(v);
+					}
+				}
+			});
+			gather(next_relabeled, relabeled);
+
+			pool.parallelFor(relabeled.size(), [&](size_t begin, size_t end, size_t) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					uint32_t v = relabeled[i], lowest = n;
+					for (size_t a = net.offsets[v]; a < net.offsets[v + 1]; ++a)
+					{
+						if (net.capacity[a] > W(0))
+						{
+							lowest = std::min(lowest, label[net.targets[a]] + 1);
+						}
+					}
+					pending[v] = std::min(lowest, n);
+				}
+			});
+
+			for (uint32_t v : relabeled)
+			{
+				label[v] = pending[v];
+				current[v] = net.offsets[v];
+				if (label[v] < n)
+				{
+					enqueue(v, 0);
+				}
+			}
+			relabels += relabeled.size();
+			gather(next_active, active);
+			pool.parallelFor(active.size(), [&](size_t begin, size_t end, size_t) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					uint32_t v = active[i];
+					queued[v].store(0, std::memory_order_relaxed);
+					excess[v] += incoming[v].exchange(W(0), std::memory_order_relaxed);
+				}
+			});
+			excess[sink] += incoming[sink].exchange(W(0), std::memory_order_relaxed);
+			excess[source] += incoming[source].exchange(W(0), std::memory_order_relaxed);
+
+			if (relabels >= n)
+			{
+				relabels = 0;
+				globalRelabel();
+			}
+			active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t v) { return label[v] >= n || !(excess[v] > W(0)); }), active.end());
+		}
+		return excess[sink];
+	}
+
+	// Maximum flow from source to sink with edge weights as capacities
+	template <typename W, typename V>
+	FlowResult<W, V> MaxFlow(const CSRGraph<W, V>& g, V source, V sink, FlowAlgorithm algorithm, parallel::ThreadPool& pool)
+	{
+		static_assert(std::is_arithmetic_v<W>, "Capacities must be numeric");
+		FlowNetwork<W> net = buildFlowNetwork(g);
+		uint32_t	   s = g.getIndex(source), t = g.getIndex(sink);
+		W			   value = 0;
+		switch (algorithm)
+		{
+			case FlowAlgorithm::Dinic:
+				value = Dinic(net, s, t);
+				break;
+			case FlowAlgorithm::PushRelabel:
+				value = PushRelabel(net, s, t);
+				break;
+			case FlowAlgorithm::ParallelPushRelabel:
+				value = ParallelPushRelabel(net, s, t, pool);
+				break;
+		}
+		return detail::makeFlowResult(g, net, t, value);
+	}
+
+	template <typename W, typename V>
+	FlowResult<W, V> MaxFlow(const WGraph<W, V>& g, V source, V sink, FlowAlgorithm algorithm = FlowAlgorithm::PushRelabel, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(algorithm == FlowAlgorithm::ParallelPushRelabel ? threads : 1);
+		return MaxFlow(toCSR(g), source, sink, algorithm, pool);
+	}
+} // namespace graph
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace parallel
+{
+	// Fixed set of worker threads reused across parallel loops. The calling thread takes part
+	// as worker 0, so a pool of one thread runs everything inline
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(size_t threads = 0)
+		{
+			if (threads == 0)
+			{
+				threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+			}
+			for (size_t i = 1; i < threads; ++i)
+			{
+				workers.emplace_back([this, i] { workerLoop(i); });
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		size_t getThreadsCount() const { return workers.size() + 1; }
+
+		// Runs task(worker) once on every worker and blocks until all of them return. The first
+		// exception thrown by any worker is rethrown here once every worker has finished
+		void runOnAll(const std::function<void(size_t)>& task)
+		{
+			if (workers.empty())
+			{
+				task(0);
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				current = &task;
+				pending = workers.size();
+				error = nullptr;
+				++generation;
+			}
+			wake.notify_all();
+			run(task, 0);
+
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [this] { return pending == 0; });
+			current = nullptr;
+			if (error)
+			{
+				std::rethrow_exception(std::exchange(error, nullptr));
+			}
+		}
+
+		// Hands out [0, count) in chunks of at least grain indices, body(begin, end, worker)
+		template <typename F>
+		void parallelFor(size_t count, F&& body, size_t grain = 0)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+			if (grain == 0)
+			{
+				grain = std::max<size_t>(1, count / (getThreadsCount() * 8));
+			}
+			std::atomic<size_t> next(0);
+			runOnAll([&](size_t worker) {
+				for (size_t begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain))
+				{
+					body(begin, std::min(count, begin + grain), worker);
+				}
+			});
+		}
+
+	private:
+		void run(const std::function<void(size_t)>& task, size_t worker)
+		{
+			try
+			{
+				task(worker);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+			}
+		}
+
+		void workerLoop(size_t id)
+		{
+			size_t seen = 0;
+			for (;;)
+			{
+				const std::function<void(size_t)>* task;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					wake.wait(lock, [&] { return stopping || generation != seen; });
+					if (stopping)
+					{
+						return;
+					}
+					seen = generation;
+					task = current;
+				}
+				run(*task, id);
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					--pending;
+				}
+				done.notify_one();
+			}
+		}
+
+		std::vector<std::thread>		   workers;
+		std::mutex						   mutex;
+		std::condition_variable			   wake;
+		std::condition_variable			   done;
+		const std::function<void(size_t)>* current = nullptr;
+		std::exception_ptr				   error;
+		size_t							   pending = 0;
+		size_t							   generation = 0;
+		bool							   stopping = false;
+	};
+
+	// Sorts chunks on every worker, then merges neighbouring runs in parallel rounds
+	template <typename T, typename Compare>
+	void parallelSort(std::vector<T>& data, Compare less, ThreadPool& pool)
+	{
+		size_t chunks = pool.getThreadsCount();
+		size_t chunk = (data.size() + chunks - 1) / std::max<size_t>(1, chunks);
+		if (chunks <= 1 || data.size() < 4096)
+		{
+			std::sort(data.begin(), data.end(), less);
+			return;
+		}
+
+		pool.parallelFor(chunks, [&](size_t begin, size_t end, size_t) {
+			for (size_t c = begin; c < end; ++c)
+			{
+				size_t from = std::min(data.size(), c * chunk), to = std::min(data.size(), (c + 1) * chunk);
+				std::sort(data.begin() + from, data.begin() + to, less);
+			}
+		}, 1);
+
+		for (size_t width = chunk; width < data.size(); width *= 2)
+		{
+			size_t pairs = (data.size() + 2 * width - 1) / (2 * width);
+			pool.parallelFor(pairs, [&](size_t begin, size_t end, size_t) {
+				for (size_t p = begin; p < end; ++p)
+				{
+					size_t from = p * 2 * width;
+					size_t middle = std::min(data.size(), from + width), to = std::min(data.size(), from + 2 * width);
+					std::inplace_merge(data.begin() + from, data.begin() + middle, data.begin() + to, less);
+				}
+			}, 1);
+		}
+	}
+
+	// Lock-free "target = min(target, value)", returns true if value was stored
+	template <typename T>
+	bool atomicMin(std::atomic<T>& target, T value)
+	{
+		T current = target.load(std::memory_order_relaxed);
+		while (value < current)
+		{
+			if (target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+} // namespace parallel
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+namespace graph
+{
+	// LRU cache of shortest-path trees keyed by source, for workloads that repeat sources.
+	// A hit costs only the path reconstruction. Trees are tagged with the graph version they
+	// were computed at and the whole cache is dropped as soon as the graph changes. The
+	// memory bound is an estimate of the hash map footprint of the cached trees; the most
+	// recently used tree is always kept, even if it alone exceeds the bound
+	template <typename W = unsigned int, typename V = int>
+	class ShortestPathCache
+	{
+	public:
+		explicit ShortestPathCache(const WGraph<W, V>& g, size_t max_bytes = size_t(64) << 20)
+			: graph(g)
+			, max_bytes(max_bytes)
+			, version(g.version)
+		{
+		}
+
+		// Same result as findPath(from, to, graph) with the SingleSource policy
+		std::pair<std::vector<V>, W> findPath(V from, V to)
+		{
+			const ShortestPathTree<W, V>& tree = getTree(from);
+			return std::make_pair(tree.getPath(to), tree.getCost(to));
+		}
+
+		const ShortestPathTree<W, V>& getTree(V from)
+		{
+			if (version != graph.version)
+			{
+				clear();
+				version = graph.version;
+				++invalidations;
+			}
+
+			auto it = index.find(from);
+			if (it != index.end())
+			{
+				++hits;
+				entries.splice(entries.begin(), entries, it->second);
+				return it->second->tree;
+			}
+
+			++misses;
+			Entry entry;
+			entry.tree = getShortestPathTree(from, graph);
+			entry.bytes = estimateBytes(entry.tree);
+			bytes += entry.bytes;
+			entries.push_front(std::move(entry));
+			index.emplace(from, entries.begin());
+			while (bytes > max_bytes && entries.size() > 1)
+			{
+				bytes -= entries.back().bytes;
+				index.erase(entries.back().tree.source);
+				entries.pop_back();
+				++evictions;
+			}
+			return entries.front().tree;
+		}
+
+		void clear()
+		{
+			entries.clear();
+			index.clear();
+			bytes = 0;
+		}
+
+		size_t getHits() const { return hits; }
+		size_t getMisses() const { return misses; }
+		size_t getEvictions() const { return evictions; }
+		size_t getInvalidations() const { return invalidations; }
+		size_t getCachedCount() const { return entries.size(); }
+		size_t getBytesCount() const { return bytes; }
+
+		double getHitRate() const
+		{
+			size_t queries = hits + misses;
+			return queries ? double(hits) / queries : 0.0;
+		}
+
+		void resetCounters() { hits = misses = evictions = invalidations = 0; }
+
+	private:
+		struct Entry
+		{
+			ShortestPathTree<W, V> tree;
+			size_t				   bytes = 0;
+		};
+
+		// Node-based hash map: key, value and next pointer per entry plus one bucket pointer
+		static size_t estimateBytes(const ShortestPathTree<W, V>& tree)
+		{
+			size_t per_cost = sizeof(std::pair<const V, W>) + 2 * sizeof(void*);
+			size_t per_parent = sizeof(std::pair<const V, V>) + 2 * sizeof(void*);
+			return sizeof(Entry) + tree.costs.size() * per_cost + tree.parents.size() * per_parent;
+		}
+
+		const WGraph<W, V>&										   graph;
+		size_t													   max_bytes;
+		size_t													   version;
+		size_t													   bytes = 0;
+		std::list<Entry>										   entries; // most recently used first
+		std::unordered_map<V, typename std::list<Entry>::iterator> index;
+		size_t													   hits = 0;
+		size_t													   misses = 0;
+		size_t													   evictions = 0;
+		size_t													   invalidations = 0;
+	};
+} // namespace graph
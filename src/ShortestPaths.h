@@ -0,0 +1,583 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+namespace graph
+{
+	namespace detail
+	{
+		template <typename W, typename V>
+		std::unordered_map<V, W> toNodeMap(const std::vector<W>& dist, const std::vector<V>& ids)
+		{
+			std::unordered_map<V, W> res;
+			res.reserve(dist.size());
+			for (size_t i = 0; i < dist.size(); ++i)
+			{
+				res[ids[i]] = dist[i];
+			}
+			return res;
+		}
+	} // namespace detail
+
+	// Delta-stepping single-source shortest paths (Meyer & Sanders) over dense indices.
+	// Tentative distances are kept in buckets of width delta; each bucket is drained by
+	// repeated parallel relaxation of its light edges (weight <= delta), after which the heavy
+	// edges of everything it settled are relaxed once. Requires non-negative weights
+	template <typename W, typename V>
+	std::vector<W> DeltaStepping(uint32_t from, const CSRGraph<W, V>& g, W delta, parallel::ThreadPool& pool)
+	{
+		constexpr W inf = std::numeric_limits<W>::max();
+		if (!(delta > W(0)))
+		{
+			throw std::invalid_argument("Delta must be positive");
+		}
+
+		size_t						n = g.getNodesCount();
+		std::vector<std::atomic<W>> dist(n);
+		for (auto& d : dist)
+		{
+			d.store(inf, std::memory_order_relaxed);
+		}
+		dist[from].store(0, std::memory_order_relaxed);
+
+		auto bucketOf = [delta](W d) { return static_cast<size_t>(d / delta); };
+
+		// every queued distance lies within max_weight of the current bucket, so the buckets
+		// form a ring indexed modulo its size and memory stays O(max_weight / delta)
+		W max_weight = W(0);
+		for (size_t e = 0; e < g.getEdgesCount(); ++e)
+		{
+			max_weight = std::max(max_weight, g.getWeight(e));
+		}
+		size_t ring = static_cast<size_t>(max_weight / delta) + 2;
+
+		std::vector<std::vector<uint32_t>>				buckets(ring);
+		std::vector<std::vector<std::vector<uint32_t>>> local_bins(pool.getThreadsCount(), std::vector<std::vector<uint32_t>>(ring));
+		std::vector<std::vector<uint32_t>>				local_settled(pool.getThreadsCount());
+		size_t											queued = 1;
+		buckets[bucketOf(0) % ring].push_back(from);
+
+		// moves thread-local bins into the shared buckets between phases
+		auto mergeBins = [&]() {
+			for (auto& bins : local_bins)
+			{
+				for (size_t b = 0; b < ring; ++b)
+				{
+					queued += bins[b].size();
+					buckets[b].insert(buckets[b].end(), bins[b].begin(), bins[b].end());
+					bins[b].clear();
+				}
+			}
+		};
+
+		auto relax = [&](uint32_t node, bool light, size_t worker) {
+			W d = dist[node].load(std::memory_order_relaxed);
+			for (size_t e = g.offsets[node]; e < g.offsets[node + 1]; ++e)
+			{
+				W weight = g.getWeight(e);
+				if ((weight <= delta) != light)
+				{
+					continue;
+				}
+				W new_dist = d + weight;
+				if (parallel::atomicMin(dist[g.targets[e]], new_dist))
+				{
+					local_bins[worker][bucketOf(new_dist) % ring].push_back(g.targets[e]);
+				}
+			}
+		};
+
+		for (size_t current = 0; queued > 0; ++current)
+		{
+			auto&				  bucket = buckets[current % ring];
+			std::vector<uint32_t> settled;
+			while (!bucket.empty())
+			{
+				std::vector<uint32_t> frontier;
+				frontier.swap(bucket);
+				queued -= frontier.size();
+				pool.parallelFor(frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+					for (size_t i = begin; i < end; ++i)
+					{
+						uint32_t node = frontier[i];
+						// an improved node is queued again, the copy left in its old bucket is stale
+						if (bucketOf(dist[node].load(std::memory_order_relaxed)) != current)
+						{
+							continue;
+						}
+						local_settled[worker].push_back(node);
+						relax(node, true, worker);
+					}
+				});
+				mergeBins();
+			}
+
+			for (auto& local : local_settled)
+			{
+				settled.insert(settled.end(), local.begin(), local.end());
+				local.clear();
+			}
+			std::sort(settled.begin(), settled.end());
+			settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+			pool.parallelFor(settled.size(), [&](size_t begin, size_t end, size_t worker) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					relax(settled[i], false, worker);
+				}
+			});
+			mergeBins();
+		}
+
+		std::vector<W> res(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			res[i] = dist[i].load(std::memory_order_relaxed);
+		}
+		return res;
+	}
+
+	// Same output as Dijkstra(from, g): every node mapped to its distance, maximum W if unreachable
+	template <typename W, typename V>
+	std::unordered_map<V, W> DeltaStepping(V from, const WGraph<W, V>& g, W delta, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		CSRGraph<W, V>		 csr = toCSR(g);
+		return detail::toNodeMap(DeltaStepping(csr.getIndex(from), csr, delta, pool), csr.ids);
+	}
+
+	// Queue-based Bellman-Ford (SPFA): only nodes whose distance dropped are rescanned.
+	// A node reached by a shortest-path candidate of n or more edges proves a negative cycle
+	template <typename W, typename V>
+	std::vector<W> SPFA(uint32_t from, const CSRGraph<W, V>& g)
+	{
+		constexpr W			 inf = std::numeric_limits<W>::max();
+		size_t				 n = g.getNodesCount();
+		std::vector<W>		 dist(n, inf);
+		std::vector<size_t>	 hops(n, 0);
+		std::vector<bool>	 queued(n, false);
+		std::deque<uint32_t> queue;
+
+		dist[from] = 0;
+		queue.push_back(from);
+		queued[from] = true;
+		while (!queue.empty())
+		{
+			uint32_t node = queue.front();
+			queue.pop_front();
+			queued[node] = false;
+
+			W d = dist[node];
+			for (size_t e = g.offsets[node]; e < g.offsets[node + 1]; ++e)
+			{
+				uint32_t next = g.targets[e];
+				W		 new_dist = d + g.getWeight(e);
+				if (new_dist >= dist[next])
+				{
+					continue;
+				}
+				dist[next] = new_dist;
+				hops[next] = hops[node] + 1;
+				if (hops[next] >= n)
+				{
+					throw std::runtime_error("Graph contains negative weight cycle");
+				}
+				if (!queued[next])
+				{
+					queued[next] = true;
+					queue.push_back(next);
+				}
+			}
+		}
+		return dist;
+	}
+
+	template <typename W, typename V>
+	std::unordered_map<V, W> SPFA(V from, const WGraph<W, V>& g)
+	{
+		CSRGraph<W, V> csr = toCSR(g);
+		return detail::toNodeMap(SPFA(csr.getIndex(from), csr), csr.ids);
+	}
+
+	// Edge-centric Bellman-Ford: every pass relaxes the whole edge array split across the pool
+	// with an atomic min per target, and passes stop once one of them changes nothing.
+	// Starts from the given tentative distances (maximum W for "not reached yet")
+	template <typename W, typename V>
+	std::vector<W> ParallelBellmanFord(const std::vector<W>& initial, const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		constexpr W					inf = std::numeric_limits<W>::max();
+		size_t						n = edges.getNodesCount();
+		std::vector<std::atomic<W>> dist(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			dist[i].store(initial[i], std::memory_order_relaxed);
+		}
+
+		auto pass = [&]() {
+			std::atomic<bool> changed(false);
+			pool.parallelFor(edges.getEdgesCount(), [&](size_t begin, size_t end, size_t) {
+				bool local_changed = false;
+				for (size_t e = begin; e < end; ++e)
+				{
+					W d = dist[edges.sources[e]].load(std::memory_order_relaxed);
+					if (d != inf)
+					{
+						local_changed |= parallel::atomicMin(dist[edges.targets[e]], W(d + edges.weights[e]));
+					}
+				}
+				if (local_changed)
+				{
+					changed.store(true, std::memory_order_relaxed);
+				}
+			});
+			return changed.load();
+		};
+
+		bool changed = true;
+		for (size_t i = 0; changed && i + 1 < n; ++i)
+		{
+			changed = pass();
+		}
+		if (changed && pass())
+		{
+			throw std::runtime_error("Graph contains negative weight cycle");
+		}
+
+		std::vector<W> res(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			res[i] = dist[i].load(std::memory_order_relaxed);
+		}
+		return res;
+	}
+
+	template <typename W, typename V>
+	std::vector<W> ParallelBellmanFord(uint32_t from, const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		std::vector<W> initial(edges.getNodesCount(), std::numeric_limits<W>::max());
+		initial[from] = 0;
+		return ParallelBellmanFord(initial, edges, pool);
+	}
+
+	template <typename W, typename V>
+	std::unordered_map<V, W> ParallelBellmanFord(V from, const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		EdgeList<W, V>		 edges = toEdgeList(toCSR(g));
+		return detail::toNodeMap(ParallelBellmanFord(edges.index.at(from), edges, pool), edges.ids);
+	}
+
+	// Dense all-pairs result: row-major distances over the dense indices of the source graph,
+	// maximum W for unreachable pairs. next holds the first hop of every shortest path when
+	// requested and is empty otherwise
+	template <typename W = unsigned int, typename V = int>
+	struct DistanceMatrix
+	{
+		static constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+
+		size_t getNodesCount() const { return ids.size(); }
+
+		bool hasNextHops() const { return !next.empty(); }
+
+		W getDistance(V from, V to) const
+		{
+			return dist[index.at(from) * ids.size() + index.at(to)];
+		}
+
+		// Follows the next-hop table, empty if to is unreachable
+		std::vector<V> getPath(V from, V to) const
+		{
+			if (!hasNextHops())
+			{
+				throw std::logic_error("Distance matrix was built without next hops");
+			}
+			size_t		   n = ids.size();
+			uint32_t	   current = index.at(from), target = index.at(to);
+			std::vector<V> path;
+			if (dist[current * n + target] == std::numeric_limits<W>::max())
+			{
+				return path;
+			}
+			path.push_back(from);
+			while (current != target)
+			{
+				current = next[current * n + target];
+				path.push_back(ids[current]);
+			}
+			return path;
+		}
+
+		std::vector<W>					dist;
+		std::vector<uint32_t>			next;
+		std::vector<V>					ids;
+		std::unordered_map<V, uint32_t> index;
+	};
+
+	namespace detail
+	{
+		// Floyd-Warshall keeps unreachable entries at a sentinel that survives additions without
+		// overflowing, so the inner loop stays a branch-free add/min the compiler can vectorize.
+		// Integral path lengths must stay below a quarter of the type's range
+		template <typename W>
+		struct FloydWarshallLimits
+		{
+			static constexpr W unreachable()
+			{
+				if constexpr (std::is_floating_point_v<W>)
+				{
+					return std::numeric_limits<W>::infinity();
+				}
+				else
+				{
+					return std::numeric_limits<W>::max() / 2;
+				}
+			}
+
+			static bool isUnreachable(W d)
+			{
+				if constexpr (std::is_floating_point_v<W>)
+				{
+					return d == std::numeric_limits<W>::infinity();
+				}
+				else
+				{
+					return d > std::numeric_limits<W>::max() / 4;
+				}
+			}
+		};
+
+		// Relaxes tile (ib, jb) through pivots of tile kb
+		template <typename W>
+		void floydWarshallTile(W* dist, uint32_t* next, size_t n, size_t tile, size_t ib, size_t jb, size_t kb)
+		{
+			size_t i_end = std::min(n, (ib + 1) * tile), j_begin = jb * tile, j_end = std::min(n, (jb + 1) * tile);
+			size_t k_end = std::min(n, (kb + 1) * tile);
+			for (size_t k = kb * tile; k < k_end; ++k)
+			{
+				const W* row_k = dist + k * n;
+				for (size_t i = ib * tile; i < i_end; ++i)
+				{
+					W* row_i = dist + i * n;
+					W  dik = row_i[k];
+					if (FloydWarshallLimits<W>::isUnreachable(dik))
+					{
+						continue;
+					}
+					if (next)
+					{
+						uint32_t* next_i = next + i * n;
+						uint32_t  hop = next_i[k];
+						for (size_t j = j_begin; j < j_end; ++j)
+						{
+							W	 candidate = dik + row_k[j];
+							bool better = candidate < row_i[j];
+							row_i[j] = better ? candidate : row_i[j];
+							next_i[j] = better ? hop : next_i[j];
+						}
+					}
+					else
+					{
+						for (size_t j = j_begin; j < j_end; ++j)
+						{
+							W candidate = dik + row_k[j];
+							row_i[j] = candidate < row_i[j] ? candidate : row_i[j];
+						}
+					}
+				}
+			}
+		}
+	} // namespace detail
+
+	// Cache-blocked Floyd-Warshall for dense graphs. Each round first closes the pivot tile,
+	// then its tile row and column, then every remaining tile in parallel; tiles of
+	// tile x tile entries stay resident in cache for a whole round
+	template <typename W, typename V>
+	DistanceMatrix<W, V> FloydWarshall(const CSRGraph<W, V>& g, parallel::ThreadPool& pool, bool next_hops = false, size_t tile = 64)
+	{
+		using Limits = detail::FloydWarshallLimits<W>;
+
+		size_t				 n = g.getNodesCount();
+		DistanceMatrix<W, V> res;
+		res.ids = g.ids;
+		res.index = g.index;
+		res.dist.assign(n * n, Limits::unreachable());
+		if (next_hops)
+		{
+			res.next.assign(n * n, DistanceMatrix<W, V>::no_node);
+		}
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			res.dist[u * n + u] = 0;
+			if (next_hops)
+			{
+				res.next[u * n + u] = u;
+			}
+			for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+			{
+				W& d = res.dist[u * n + g.targets[e]];
+				if (g.getWeight(e) < d)
+				{
+					d = g.getWeight(e);
+					if (next_hops)
+					{
+						res.next[u * n + g.targets[e]] = g.targets[e];
+					}
+				}
+			}
+		}
+
+		W*		  dist = res.dist.data();
+		uint32_t* next = next_hops ? res.next.data() : nullptr;
+		size_t	  tiles = (n + tile - 1) / tile;
+		for (size_t kb = 0; kb < tiles; ++kb)
+		{
+			detail::floydWarshallTile(dist, next, n, tile, kb, kb, kb);
+			pool.parallelFor(tiles, [&](size_t begin, size_t end, size_t) {
+				for (size_t t = begin; t < end; ++t)
+				{
+					if (t != kb)
+					{
+						detail::floydWarshallTile(dist, next, n, tile, kb, t, kb);
+						detail::floydWarshallTile(dist, next, n, tile, t, kb, kb);
+					}
+				}
+			}, 1);
+			pool.parallelFor(tiles * tiles, [&](size_t begin, size_t end, size_t) {
+				for (size_t t = begin; t < end; ++t)
+				{
+					size_t ib = t / tiles, jb = t % tiles;
+					if (ib != kb && jb != kb)
+					{
+						detail::floydWarshallTile(dist, next, n, tile, ib, jb, kb);
+					}
+				}
+			}, 1);
+		}
+
+		for (size_t u = 0; u < n; ++u)
+		{
+			if (res.dist[u * n + u] < W(0))
+			{
+				throw std::runtime_error("Graph contains negative weight cycle");
+			}
+		}
+		for (W& d : res.dist)
+		{
+			if (Limits::isUnreachable(d))
+			{
+				d = std::numeric_limits<W>::max();
+			}
+		}
+		return res;
+	}
+
+	// Johnson's algorithm for sparse graphs: one Bellman-Ford pass from a virtual source
+	// (all potentials start at 0) makes every weight non-negative, then one Dijkstra per
+	// source runs in parallel and writes its row directly into the matrix
+	template <typename W, typename V>
+	DistanceMatrix<W, V> Johnson(const CSRGraph<W, V>& g, parallel::ThreadPool& pool, bool next_hops = false)
+	{
+		constexpr W inf = std::numeric_limits<W>::max();
+		using QueueItem = std::pair<W, uint32_t>;
+
+		size_t		   n = g.getNodesCount();
+		std::vector<W> potential(n, W(0));
+		if constexpr (std::is_signed_v<W>)
+		{
+			potential = ParallelBellmanFord(potential, toEdgeList(g), pool);
+		}
+
+		CSRGraph<W, V> reweighted;
+		reweighted.offsets = g.offsets;
+		reweighted.targets = g.targets;
+		reweighted.weights.resize(g.getEdgesCount());
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+			{
+				reweighted.weights[e] = g.getWeight(e) + potential[u] - potential[g.targets[e]];
+			}
+		}
+
+		DistanceMatrix<W, V> res;
+		res.ids = g.ids;
+		res.index = g.index;
+		res.dist.assign(n * n, inf);
+		if (next_hops)
+		{
+			res.next.assign(n * n, DistanceMatrix<W, V>::no_node);
+		}
+
+		std::vector<std::vector<QueueItem>> heaps(pool.getThreadsCount());
+		pool.parallelFor(n, [&](size_t begin, size_t end, size_t worker) {
+			auto& heap = heaps[worker];
+			for (size_t source = begin; source < end; ++source)
+			{
+				W*		  row = res.dist.data() + source * n;
+				uint32_t* hops = next_hops ? res.next.data() + source * n : nullptr;
+				row[source] = 0;
+				if (hops)
+				{
+					hops[source] = static_cast<uint32_t>(source);
+				}
+				heap.assign(1, QueueItem(W(0), static_cast<uint32_t>(source)));
+				while (!heap.empty())
+				{
+					std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+					auto [d, node] = heap.back();
+					heap.pop_back();
+					if (d > row[node])
+					{
+						continue;
+					}
+					for (size_t e = reweighted.offsets[node]; e < reweighted.offsets[node + 1]; ++e)
+					{
+						uint32_t next = reweighted.targets[e];
+						W		 new_dist = d + reweighted.weights[e];
+						if (new_dist < row[next])
+						{
+							row[next] = new_dist;
+							if (hops)
+							{
+								hops[next] = node == source ? next : hops[node];
+							}
+							heap.push_back(QueueItem(new_dist, next));
+							std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+						}
+					}
+				}
+				for (size_t target = 0; target < n; ++target)
+				{
+					if (row[target] != inf)
+					{
+						row[target] = row[target] - potential[source] + potential[target];
+					}
+				}
+			}
+		}, 1);
+		return res;
+	}
+
+	template <typename W, typename V>
+	DistanceMatrix<W, V> FloydWarshall(const WGraph<W, V>& g, bool next_hops = false, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return FloydWarshall(toCSR(g), pool, next_hops);
+	}
+
+	template <typename W, typename V>
+	DistanceMatrix<W, V> Johnson(const WGraph<W, V>& g, bool next_hops = false, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return Johnson(toCSR(g), pool, next_hops);
+	}
+} // namespace graph
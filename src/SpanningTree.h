@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "CSRGraph.h"
+#include "Connectivity.h"
+#include "Graph.h"
+#include "Parallel.h"
+
+namespace graph
+{
+	// Minimum spanning forest: one tree per connected component, edge direction is ignored
+	template <typename W = unsigned int, typename V = int>
+	struct SpanningTree
+	{
+		struct Edge
+		{
+			V from;
+			V to;
+			W weight;
+		};
+
+		std::vector<Edge> edges;
+		W				  total_weight = 0;
+	};
+
+	namespace detail
+	{
+		// Orders edges by weight, ties by position, so every algorithm picks the same forest
+		template <typename W, typename V>
+		struct EdgeLess
+		{
+			const EdgeList<W, V>& list;
+
+			bool operator()(size_t a, size_t b) const
+			{
+				return list.weights[a] < list.weights[b] || (!(list.weights[b] < list.weights[a]) && a < b);
+			}
+		};
+
+		template <typename W, typename V>
+		void addTreeEdge(SpanningTree<W, V>& tree, const EdgeList<W, V>& edges, size_t e)
+		{
+			tree.edges.push_back({ edges.ids[edges.sources[e]], edges.ids[edges.targets[e]], edges.weights[e] });
+			tree.total_weight += edges.weights[e];
+		}
+
+		// Runs pick(i, out) for i in [0, count) across the pool and concatenates what the calls
+		// push in index order, by giving every fixed-size chunk of indices its own output
+		template <typename T, typename F>
+		std::vector<T> collectInOrder(size_t count, parallel::ThreadPool& pool, F&& pick)
+		{
+			size_t						grain = std::max<size_t>(1024, count / (pool.getThreadsCount() * 8));
+			std::vector<std::vector<T>> chunks((count + grain - 1) / grain);
+			pool.parallelFor(count, [&](size_t begin, size_t end, size_t) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					pick(i, chunks[begin / grain]);
+				}
+			}, grain);
+			std::vector<T> res;
+			for (auto& chunk : chunks)
+			{
+				res.insert(res.end(), chunk.begin(), chunk.end());
+			}
+			return res;
+		}
+	} // namespace detail
+
+	// Kruskal: edge order is sorted across the pool, then scanned once with union-find
+	template <typename W, typename V>
+	SpanningTree<W, V> Kruskal(const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		std::vector<size_t> order(edges.getEdgesCount());
+		for (size_t e = 0; e < order.size(); ++e)
+		{
+			order[e] = e;
+		}
+		parallel::parallelSort(order, detail::EdgeLess<W, V> { edges }, pool);
+
+		SpanningTree<W, V> tree;
+		UnionFind		   sets(edges.getNodesCount());
+		for (size_t e : order)
+		{
+			if (sets.unite(edges.sources[e], edges.targets[e]))
+			{
+				detail::addTreeEdge(tree, edges, e);
+				if (sets.getSetsCount() == 1)
+				{
+					break;
+				}
+			}
+		}
+		return tree;
+	}
+
+	// Boruvka: each round every component picks its cheapest outgoing edge in one parallel
+	// sweep over the edge array (atomic per-component minimum). Each component then hooks onto
+	// the component across its pick; with the strict edge order the only cycles are pairs that
+	// picked the same edge, and there the smaller id stays root. Pointer jumping flattens the
+	// hooks and every node is relabelled with its new root, all across the pool. Only the
+	// active roots are visited per round, and their number at least halves
+	template <typename W, typename V>
+	SpanningTree<W, V> Boruvka(const EdgeList<W, V>& edges, parallel::ThreadPool& pool)
+	{
+		constexpr size_t none = std::numeric_limits<size_t>::max();
+
+		size_t							 n = edges.getNodesCount();
+		detail::EdgeLess<W, V>			 less { edges };
+		std::vector<uint32_t>			 comp(n), parent(n), jumped(n), active(n);
+		std::vector<std::atomic<size_t>> cheapest(n);
+		SpanningTree<W, V>				 tree;
+		for (uint32_t v = 0; v < n; ++v)
+		{
+			comp[v] = active[v] = v;
+		}
+
+		auto other = [&](size_t e, uint32_t c) { return comp[edges.sources[e]] == c ? comp[edges.targets[e]] : comp[edges.sources[e]]; };
+
+		while (active.size() > 1)
+		{
+			pool.parallelFor(active.size(), [&](size_t begin, size_t end, size_t) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					cheapest[active[i]].store(none, std::memory_order_relaxed);
+				}
+			});
+
+			auto offer = [&](uint32_t c, size_t e) {
+				size_t current = cheapest[c].load(std::memory_order_relaxed);
+				while ((current == none || less(e, current)) && !cheapest[c].compare_exchange_weak(current, e, std::memory_order_relaxed))
+				{
+				}
+			};
+			pool.parallelFor(edges.getEdgesCount(), [&](size_t begin, size_t end, size_t) {
+				for (size_t e = begin; e < end; ++e)
+				{
+					uint32_t cu = comp[edges.sources[e]], cv = comp[edges.targets[e]];
+					if (cu != cv)
+					{
+						offer(cu, e);
+						offer(cv, e);
+					}
+				}
+			});
+
+			// hook every component across its pick; a pair that picked the same edge adds it once
+			auto picked = detail::collectInOrder<size_t>(active.size(), pool, [&](size_t i, std::vector<size_t>& out) {
+				uint32_t c = active[i];
+				size_t	 e = cheapest[c].load(std::memory_order_relaxed);
+				parent[c] = c;
+				if (e == none)
+				{
+					return;
+				}
+				uint32_t d = other(e, c);
+				bool	 mutual = cheapest[d].load(std::memory_order_relaxed) == e;
+				if (!mutual || c > d)
+				{
+					parent[c] = d;
+				}
+				if (!mutual || c < d)
+				{
+					out.push_back(e);
+				}
+			});
+			if (picked.empty())
+			{
+				break;
+			}
+			for (size_t e : picked)
+			{
+				detail::addTreeEdge(tree, edges, e);
+			}
+
+			for (bool changed = true; changed;)
+			{
+				std::atomic<bool> any(false);
+				pool.parallelFor(active.size(), [&](size_t begin, size_t end, size_t) {
+					bool local = false;
+					for (size_t i = begin; i < end; ++i)
+					{
+						uint32_t c = active[i];
+						jumped[c] = parent[parent[c]];
+						local |= jumped[c] != parent[c];
+					}
+					if (local)
+					{
+						any.store(true, std::memory_order_relaxed);
+					}
+				});
+				parent.swap(jumped);
+				changed = any.load();
+			}
+
+			pool.parallelFor(n, [&](size_t begin, size_t end, size_t) {
+				for (size_t v = begin; v < end; ++v)
+				{
+					comp[v] = parent[comp[v]];
+				}
+			});
+			active = detail::collectInOrder<uint32_t>(active.size(), pool, [&](size_t i, std::vector<uint32_t>& out) {
+				if (parent[active[i]] == active[i])
+				{
+					out.push_back(active[i]);
+				}
+			});
+		}
+		return tree;
+	}
+
+	template <typename W, typename V>
+	SpanningTree<W, V> Kruskal(const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return Kruskal(toEdgeList(toCSR(g)), pool);
+	}
+
+	template <typename W, typename V>
+	SpanningTree<W, V> Boruvka(const WGraph<W, V>& g, size_t threads = 0)
+	{
+		parallel::ThreadPool pool(threads);
+		return Boruvka(toEdgeList(toCSR(g)), pool);
+	}
+} // namespace graph
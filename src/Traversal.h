@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+
+namespace graph
+{
+	constexpr uint32_t unreachable_hops = std::numeric_limits<uint32_t>::max();
+
+	// The traversals below work on any dense-index graph that provides getNodesCount() and
+	// forEachNeighbour(u, f(target, weight)): CSRGraph, MappedGraph and the compact layouts
+
+	// Hop counts from one source, unreachable_hops where not reached
+	template <typename Graph>
+	std::vector<uint32_t> BFSDistances(uint32_t from, const Graph& g)
+	{
+		std::vector<uint32_t> hops(g.getNodesCount(), unreachable_hops);
+		std::vector<uint32_t> fifo(1, from);
+		hops[from] = 0;
+		for (size_t head = 0; head < fifo.size(); ++head)
+		{
+			uint32_t u = fifo[head];
+			g.forEachNeighbour(u, [&](uint32_t v, auto) {
+				if (hops[v] == unreachable_hops)
+				{
+					hops[v] = hops[u] + 1;
+					fifo.push_back(v);
+				}
+			});
+		}
+		return hops;
+	}
+
+	// Nodes in depth-first preorder from one source, iterative
+	template <typename Graph>
+	std::vector<uint32_t> DFSOrder(uint32_t from, const Graph& g)
+	{
+		std::vector<bool>	  visited(g.getNodesCount(), false);
+		std::vector<uint32_t> order, lifo(1, from), children;
+		while (!lifo.empty())
+		{
+			uint32_t u = lifo.back();
+			lifo.pop_back();
+			if (visited[u])
+			{
+				continue;
+			}
+			visited[u] = true;
+			order.push_back(u);
+
+			// reversed so the first neighbour is visited first
+			children.clear();
+			g.forEachNeighbour(u, [&](uint32_t v, auto) {
+				if (!visited[v])
+				{
+					children.push_back(v);
+				}
+			});
+			lifo.insert(lifo.end(), children.rbegin(), children.rend());
+		}
+		return order;
+	}
+
+	// Distances from one source, maximum W where not reached. Non-negative weights
+	template <typename Graph, typename W = typename Graph::Weight>
+	std::vector<W> DijkstraDistances(uint32_t from, const Graph& g)
+	{
+		using QueueItem = std::pair<W, uint32_t>;
+		std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> heap;
+		std::vector<W>																	dist(g.getNodesCount(), std::numeric_limits<W>::max());
+
+		dist[from] = 0;
+		heap.push(QueueItem(W(0), from));
+		while (!heap.empty())
+		{
+			auto [d, u] = heap.top();
+			heap.pop();
+			if (d > dist[u])
+			{
+				continue;
+			}
+			g.forEachNeighbour(u, [&](uint32_t v, W weight) {
+				if (d + weight < dist[v])
+				{
+					dist[v] = d + weight;
+					heap.push(QueueItem(dist[v], v));
+				}
+			});
+		}
+		return dist;
+	}
+
+	// Reusable state for repeated searches on dense-index graphs of up to a given size: cost,
+	// parent and visit marks per node, the frontier and the visit order. Marks are valid only
+	// where their stamp equals the current epoch, so start() is O(1) and searches that fit in
+	// the grown buffers allocate nothing. Results stay readable until the next search
+	template <typename W = unsigned int>
+	class TraversalWorkspace
+	{
+	public:
+		static constexpr uint32_t no_target = std::numeric_limits<uint32_t>::max();
+
+		explicit TraversalWorkspace(size_t n = 0) { reserve(n); }
+
+		void reserve(size_t n)
+		{
+			if (stamp.size() < n)
+			{
+				dist.resize(n);
+				parent.resize(n);
+				stamp.resize(n, 0);
+				done.resize(n, 0);
+			}
+		}
+
+		// Invalidates every mark of the previous search
+		void start(size_t n)
+		{
+			reserve(n);
+			if (++epoch == 0)
+			{
+				std::fill(stamp.begin(), stamp.end(), 0);
+				std::fill(done.begin(), done.end(), 0);
+				epoch = 1;
+			}
+			frontier.clear();
+			heap.clear();
+			order.clear();
+		}
+
+		bool isReached(uint32_t u) const { return u < stamp.size() && stamp[u] == epoch; }
+
+		// Hops for BFS, depth for DFS, cost for Dijkstra; maximum W where not reached
+		W getDist(uint32_t u) const { return isReached(u) ? dist[u] : std::numeric_limits<W>::max(); }
+
+		uint32_t getParent(uint32_t u) const { return parent[u]; }
+
+		// Dense path from the last source to "to" inclusive, empty if "to" was not reached
+		std::vector<uint32_t> getPath(uint32_t to) const
+		{
+			std::vector<uint32_t> path;
+			if (!isReached(to))
+			{
+				return path;
+			}
+			for (path.push_back(to); path.back() != source; path.push_back(parent[path.back()]))
+			{
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		// Nodes in the order they were expanded (settled, for Dijkstra)
+		const std::vector<uint32_t>& getOrder() const { return order; }
+
+		void reach(uint32_t u, W d, uint32_t from)
+		{
+			dist[u] = d;
+			parent[u] = from;
+			stamp[u] = epoch;
+		}
+
+		bool isDone(uint32_t u) const { return done[u] == epoch; }
+
+		void markDone(uint32_t u)
+		{
+			done[u] = epoch;
+			order.push_back(u);
+		}
+
+		uint32_t							source = 0;
+		std::vector<uint32_t>				frontier;
+		std::vector<std::pair<W, uint32_t>> heap;
+
+	private:
+		std::vector<W>		  dist;
+		std::vector<uint32_t> parent;
+		std::vector<uint32_t> stamp;
+		std::vector<uint32_t> done;
+		std::vector<uint32_t> order;
+		uint32_t			  epoch = 0;
+	};
+
+	namespace detail
+	{
+		// Dijkstra into ws, stop(u) is asked after every settled node and ends the search early
+		template <typename Graph, typename W, typename Stop>
+		void dijkstraSearch(uint32_t from, const Graph& g, TraversalWorkspace<W>& ws, Stop&& stop)
+		{
+			std::greater<std::pair<W, uint32_t>> later;
+			ws.start(g.getNodesCount());
+			ws.source = from;
+			ws.reach(from, W(0), from);
+			ws.heap.emplace_back(W(0), from);
+			while (!ws.heap.empty())
+			{
+				std::pop_heap(ws.heap.begin(), ws.heap.end(), later);
+				auto [d, u] = ws.heap.back();
+				ws.heap.pop_back();
+				if (ws.isDone(u))
+				{
+					continue;
+				}
+				ws.markDone(u);
+				if (stop(u))
+				{
+					return;
+				}
+				g.forEachNeighbour(u, [&](uint32_t v, W weight) {
+					if (d + weight < ws.getDist(v))
+					{
+						ws.reach(v, d + weight, u);
+						ws.heap.emplace_back(d + weight, v);
+						std::push_heap(ws.heap.begin(), ws.heap.end(), later);
+					}
+				});
+			}
+		}
+	} // namespace detail
+
+	// Workspace variants of the traversals above: results are read from ws (getDist, getPath,
+	// getOrder) and the search stops as soon as "to" is expanded. Returns whether "to" was
+	// reached; with no target the whole reachable part is explored and true is returned
+	template <typename Graph, typename W>
+	bool BFSSearch(uint32_t from, const Graph& g, TraversalWorkspace<W>& ws, uint32_t to = TraversalWorkspace<W>::no_target)
+	{
+		ws.start(g.getNodesCount());
+		ws.source = from;
+		ws.reach(from, W(0), from);
+		ws.frontier.push_back(from);
+		for (size_t head = 0; head < ws.frontier.size(); ++head)
+		{
+			uint32_t u = ws.frontier[head];
+			ws.markDone(u);
+			if (u == to)
+			{
+				return true;
+			}
+			W d = ws.getDist(u) + 1;
+			g.forEachNeighbour(u, [&](uint32_t v, auto) {
+				if (!ws.isReached(v))
+				{
+					ws.reach(v, d, u);
+					ws.frontier.push_back(v);
+				}
+			});
+		}
+		return to == TraversalWorkspace<W>::no_target;
+	}
+
+	// Preorder matches DFSOrder
+	template <typename Graph, typename W>
+	bool DFSSearch(uint32_t from, const Graph& g, TraversalWorkspace<W>& ws, uint32_t to = TraversalWorkspace<W>::no_target)
+	{
+		ws.start(g.getNodesCount());
+		ws.source = from;
+		ws.reach(from, W(0), from);
+		ws.frontier.push_back(from);
+		while (!ws.frontier.empty())
+		{
+			uint32_t u = ws.frontier.back();
+			ws.frontier.pop_back();
+			if (ws.isDone(u))
+			{
+				continue;
+			}
+			ws.markDone(u);
+			if (u == to)
+			{
+				return true;
+			}
+
+			// a node pushed several times keeps the parent of its latest push, which is popped first
+			size_t pushed = ws.frontier.size();
+			W	   d = ws.getDist(u) + 1;
+			g.forEachNeighbour(u, [&](uint32_t v, auto) {
+				if (!ws.isDone(v))
+				{
+					ws.reach(v, d, u);
+					ws.frontier.push_back(v);
+				}
+			});
+			std::reverse(ws.frontier.begin() + pushed, ws.frontier.end());
+		}
+		return to == TraversalWorkspace<W>::no_target;
+	}
+
+	// Non-negative weights
+	template <typename Graph, typename W>
+	bool DijkstraSearch(uint32_t from, const Graph& g, TraversalWorkspace<W>& ws, uint32_t to = TraversalWorkspace<W>::no_target)
+	{
+		detail::dijkstraSearch(from, g, ws, [to](uint32_t u) { return u == to; });
+		return to == TraversalWorkspace<W>::no_target || ws.isDone(to);
+	}
+
+	// Multi-source BFS (Then et al., "The More the Merrier"). Up to 64 * Words searches run
+	// together: every node keeps one bit per search in its seen / frontier masks, so a single
+	// scan of a node's adjacency advances all searches that currently have it in their frontier.
+	// Returns hop counts per source over dense indices, unreachable_hops where not reached
+	template <size_t Words = 4, typename W, typename V>
+	std::vector<std::vector<uint32_t>> MultiSourceBFS(const CSRGraph<W, V>& g, const std::vector<uint32_t>& sources)
+	{
+		using Lanes = std::array<uint64_t, Words>;
+		constexpr size_t batch = 64 * Words;
+
+		size_t							   n = g.getNodesCount();
+		std::vector<std::vector<uint32_t>> res(sources.size(), std::vector<uint32_t>(n, unreachable_hops));
+		std::vector<Lanes>				   seen(n), visit(n), visit_next(n);
+
+		auto any = [](const Lanes& lanes) {
+			uint64_t bits = 0;
+			for (uint64_t word : lanes)
+			{
+				bits |= word;
+			}
+			return bits != 0;
+		};
+
+		for (size_t first = 0; first < sources.size(); first += batch)
+		{
+			size_t count = std::min(batch, sources.size() - first);
+			std::fill(seen.begin(), seen.end(), Lanes {});
+			std::fill(visit.begin(), visit.end(), Lanes {});
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t source = sources[first + i];
+				seen[source][i / 64] |= uint64_t(1) << (i % 64);
+				visit[source][i / 64] |= uint64_t(1) << (i % 64);
+				res[first + i][source] = 0;
+			}
+
+			for (uint32_t level = 1;; ++level)
+			{
+				bool active = false;
+				for (uint32_t u = 0; u < n; ++u)
+				{
+					if (!any(visit[u]))
+					{
+						continue;
+					}
+					for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+					{
+						Lanes& next = visit_next[g.targets[e]];
+						for (size_t w = 0; w < Words; ++w)
+						{
+							next[w] |= visit[u][w];
+						}
+					}
+				}
+
+				for (uint32_t v = 0; v < n; ++v)
+				{
+					for (size_t w = 0; w < Words; ++w)
+					{
+						uint64_t fresh = visit_next[v][w] & ~seen[v][w];
+						visit_next[v][w] = 0;
+						visit[v][w] = fresh;
+						seen[v][w] |= fresh;
+						active |= fresh != 0;
+						for (; fresh != 0; fresh &= fresh - 1)
+						{
+							res[first + w * 64 + std::countr_zero(fresh)][v] = level;
+						}
+					}
+				}
+				if (!active)
+				{
+					break;
+				}
+			}
+		}
+		return res;
+	}
+
+	// Rows follow sources, columns follow the order of graph.nodes (the dense order of toCSR)
+	template <size_t Words = 4, typename V>
+	std::vector<std::vector<uint32_t>> MultiSourceBFS(const UGraph<V>& graph, const std::vector<V>& sources)
+	{
+		auto				  csr = toCSR(graph);
+		std::vector<uint32_t> dense;
+		dense.reserve(sources.size());
+		for (V source : sources)
+		{
+			dense.push_back(csr.getIndex(source));
+		}
+		return MultiSourceBFS<Words>(csr, dense);
+	}
+} // namespace graph
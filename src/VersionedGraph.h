@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "Graph.h"
+#include "Traversal.h"
+
+namespace graph
+{
+	// Edges of one or more published batches, sorted by source (insertion order among equal
+	// sources), with the nodes first seen in them. Shared by every version that contains it
+	template <typename W = unsigned int, typename V = int>
+	struct DeltaSegment
+	{
+		struct Edge
+		{
+			uint32_t source;
+			uint32_t target;
+			W		 weight;
+		};
+
+		std::vector<Edge>				edges;
+		uint32_t						first_node = 0; // dense index of added_ids[0]
+		std::vector<V>					added_ids;
+		std::unordered_map<V, uint32_t> added_index;
+	};
+
+	// Immutable version of a growing graph: a CSR base shared by every version built on it,
+	// plus the edges added since as a short chain of immutable segments, oldest first. Nodes
+	// first seen after the base was built get the indices following the base's. Dense-index
+	// interface, so the generic traversals and workspace searches run on it
+	template <typename W = unsigned int, typename V = int>
+	struct GraphSnapshot
+	{
+		using Weight = W;
+		using Vertex = V;
+		using Segment = DeltaSegment<W, V>;
+		using Edge = typename Segment::Edge;
+
+		size_t getNodesCount() const { return base->getNodesCount() + getAddedNodesCount(); }
+
+		size_t getEdgesCount() const { return base->getEdgesCount() + getDeltaCount(); }
+
+		size_t getAddedNodesCount() const { return segments.empty() ? 0 : segments.back()->first_node + segments.back()->added_ids.size() - base->getNodesCount(); }
+
+		// Edges not yet folded into the base
+		size_t getDeltaCount() const
+		{
+			size_t count = 0;
+			for (auto& segment : segments)
+			{
+				count += segment->edges.size();
+			}
+			return count;
+		}
+
+		template <typename F>
+		void forEachNeighbour(uint32_t u, F&& f) const
+		{
+			if (u < base->getNodesCount())
+			{
+				base->forEachNeighbour(u, f);
+			}
+			for (auto& segment : segments)
+			{
+				auto& edges = segment->edges;
+				auto  first = std::lower_bound(edges.begin(), edges.end(), u, [](const Edge& e, uint32_t source) { return e.source < source; });
+				for (; first != edges.end() && first->source == u; ++first)
+				{
+					f(first->target, first->weight);
+				}
+			}
+		}
+
+		bool contains(V node) const { return base->index.count(node) || findAdded(node) != nullptr; }
+
+		uint32_t getIndex(V node) const
+		{
+			auto it = base->index.find(node);
+			if (it != base->index.end())
+			{
+				return it->second;
+			}
+			const uint32_t* added = findAdded(node);
+			if (!added)
+			{
+				throw std::out_of_range("Node is not in the graph");
+			}
+			return *added;
+		}
+
+		V getId(uint32_t u) const
+		{
+			if (u < base->getNodesCount())
+			{
+				return base->ids[u];
+			}
+			auto segment = std::partition_point(segments.begin(), segments.end(), [u](auto& s) { return s->first_node + s->added_ids.size() <= u; });
+			return (*segment)->added_ids[u - (*segment)->first_node];
+		}
+
+		const uint32_t* findAdded(V node) const
+		{
+			for (auto& segment : segments)
+			{
+				auto it = segment->added_index.find(node);
+				if (it != segment->added_index.end())
+				{
+					return &it->second;
+				}
+			}
+			return nullptr;
+		}
+
+		uint64_t									version = 0;
+		std::shared_ptr<const CSRGraph<W, V>>		base;
+		std::vector<std::shared_ptr<const Segment>> segments;
+	};
+
+	// Graph shared between concurrent readers and writers. Readers call getSnapshot() and work
+	// on the returned immutable version for as long as they like: taking the snapshot holds a
+	// short internal lock to copy one shared_ptr, the traversal itself takes no locks. Writers
+	// queue edges with addEdge and make them visible together with publish(), which builds
+	// the next version and swaps it in. A version is freed once the last reader holding it
+	// drops its pointer (read-copy-update, with reference counts as the grace period).
+	// A publish adds its batch as a new segment and shares the older ones; neighbouring
+	// segments are merged whenever the newer one reaches half the size of the older one, so a
+	// version has O(log delta) segments and each edge is copied O(log) times. When the delta
+	// grows past compaction_threshold edges, publish folds it into a new CSR base
+	template <typename W = unsigned int, typename V = int>
+	class VersionedGraph
+	{
+	public:
+		using Snapshot = GraphSnapshot<W, V>;
+		using Segment = DeltaSegment<W, V>;
+
+		explicit VersionedGraph(const WGraph<W, V>& initial = WGraph<W, V>(), size_t compaction_threshold = size_t(1) << 16)
+			: compaction_threshold(compaction_threshold)
+		{
+			auto first = std::make_shared<Snapshot>();
+			first->base = std::make_shared<const CSRGraph<W, V>>(toCSR(initial));
+			current = std::move(first);
+		}
+
+		std::shared_ptr<const Snapshot> getSnapshot() const
+		{
+			std::lock_guard<std::mutex> lock(snapshot_mutex);
+			return current;
+		}
+
+		uint64_t getVersion() const { return getSnapshot()->version; }
+
+		// Queued until the next publish, invisible to readers before that
+		void addEdge(V from, V to, W weight)
+		{
+			std::lock_guard<std::mutex> lock(write_mutex);
+			pending.emplace_back(from, to, weight);
+		}
+
+		// Publishes every queued edge as one new version and returns its number
+		uint64_t publish()
+		{
+			std::lock_guard<std::mutex> lock(write_mutex);
+			std::shared_ptr<const Snapshot> old = current; // only publish replaces it
+			if (pending.empty())
+			{
+				return old->version;
+			}
+
+			auto next = std::make_shared<Snapshot>();
+			next->version = old->version + 1;
+			next->base = old->base;
+			next->segments = old->segments;
+
+			auto batch = std::make_shared<Segment>();
+			batch->first_node = uint32_t(old->getNodesCount());
+			auto index_of = [&](V node) {
+				auto it = next->base->index.find(node);
+				if (it != next->base->index.end())
+				{
+					return it->second;
+				}
+				if (const uint32_t* added = old->findAdded(node))
+				{
+					return *added;
+				}
+				auto [added, inserted] = batch->added_index.emplace(node, uint32_t(batch->first_node + batch->added_ids.size()));
+				if (inserted)
+				{
+					batch->added_ids.push_back(node);
+				}
+				return added->second;
+			};
+
+			batch->edges.reserve(pending.size());
+			for (auto& [from, to, weight] : pending)
+			{
+				uint32_t source = index_of(from);
+				batch->edges.push_back({ source, index_of(to), weight });
+			}
+			pending.clear();
+			std::stable_sort(batch->edges.begin(), batch->edges.end(), bySource);
+			next->segments.push_back(std::move(batch));
+			mergeSegments(next->segments);
+
+			if (next->getDeltaCount() > compaction_threshold)
+			{
+				compact(*next);
+			}
+			{
+				std::lock_guard<std::mutex> lock(snapshot_mutex);
+				current = std::move(next);
+			}
+			return old->version + 1;
+		}
+
+	private:
+		static bool bySource(const typename Segment::Edge& a, const typename Segment::Edge& b) { return a.source < b.source; }
+
+		// Merges the newest segments while the newer is at least half the older one's size,
+		// keeping sizes geometrically decreasing towards the end of the chain
+		static void mergeSegments(std::vector<std::shared_ptr<const Segment>>& segments)
+		{
+			while (segments.size() >= 2 && 2 * segments.back()->edges.size() >= segments[segments.size() - 2]->edges.size())
+			{
+				const Segment& older = *segments[segments.size() - 2];
+				const Segment& newer = *segments.back();
+				auto		   merged = std::make_shared<Segment>();
+				merged->edges.resize(older.edges.size() + newer.edges.size());
+				std::merge(older.edges.begin(), older.edges.end(), newer.edges.begin(), newer.edges.end(), merged->edges.begin(), bySource);
+				merged->first_node = older.first_node;
+				merged->added_ids = older.added_ids;
+				merged->added_ids.insert(merged->added_ids.end(), newer.added_ids.begin(), newer.added_ids.end());
+				merged->added_index = older.added_index;
+				merged->added_index.insert(newer.added_index.begin(), newer.added_index.end());
+				segments.pop_back();
+				segments.back() = std::move(merged);
+			}
+		}
+
+		// Rebuilds the base from base + segments; node indices stay the same
+		static void compact(Snapshot& snapshot)
+		{
+			size_t				  m = snapshot.getEdgesCount();
+			std::vector<uint32_t> sources, targets;
+			std::vector<W>		  weights;
+			sources.reserve(m);
+			targets.reserve(m);
+			weights.reserve(m);
+			for (uint32_t u = 0; u < snapshot.getNodesCount(); ++u)
+			{
+				snapshot.forEachNeighbour(u, [&](uint32_t v, W weight) {
+					sources.push_back(u);
+					targets.push_back(v);
+					weights.push_back(weight);
+				});
+			}
+			std::vector<V> ids = snapshot.base->ids;
+			for (auto& segment : snapshot.segments)
+			{
+				ids.insert(ids.end(), segment->added_ids.begin(), segment->added_ids.end());
+			}
+			snapshot.base = std::make_shared<const CSRGraph<W, V>>(buildCSR<W, V>(std::move(ids), sources, targets, weights));
+			snapshot.segments.clear();
+		}
+
+		mutable std::mutex				 snapshot_mutex; // guards current only
+		std::shared_ptr<const Snapshot>	 current;
+		std::mutex						 write_mutex;
+		std::vector<std::tuple<V, V, W>> pending;
+		size_t							 compaction_threshold;
+	};
+
+	// Dijkstra on one version; the workspace variant allocates nothing in steady state.
+	// Non-negative weights
+	template <typename W, typename V>
+	std::pair<std::vector<V>, W> findPath(V from, V to, const GraphSnapshot<W, V>& g, TraversalWorkspace<W>& ws)
+	{
+		std::pair<std::vector<V>, W> res(std::vector<V>(), std::numeric_limits<W>::max());
+		if (!g.contains(from) || !g.contains(to))
+		{
+			return res;
+		}
+		uint32_t target = g.getIndex(to);
+		if (DijkstraSearch(g.getIndex(from), g, ws, target))
+		{
+			for (uint32_t u : ws.getPath(target))
+			{
+				res.first.push_back(g.getId(u));
+			}
+			res.second = ws.getDist(target);
+		}
+		return res;
+	}
+
+	template <typename W, typename V>
+	std::pair<std::vector<V>, W> findPath(V from, V to, const GraphSnapshot<W, V>& g)
+	{
+		TraversalWorkspace<W> ws;
+		return findPath(from, to, g, ws);
+	}
+} // namespace graph
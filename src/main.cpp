@@ -7,6 +7,32 @@
 #include "Graph.h"
 #include "Vector.h"
 #include "SLE_algorithms.h"
+#include "ContractionHierarchy.h"
+#include "ShortestPaths.h"
+#include "Traversal.h"
+#include "Connectivity.h"
+#include "SpanningTree.h"
+#include "GraphIO.h"
+#include "GraphReorder.h"
+#include "CompressedGraph.h"
+#include "IncrementalShortestPaths.h"
+#include "PathCache.h"
+#include "BatchQueries.h"
+#include "Centrality.h"
+#include "MaxFlow.h"
+#include "GridGraph.h"
+#include "VersionedGraph.h"
+#include "LSMGraph.h"
+#include "EdgeRelaxation.h"
+#include <thread>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <tuple>
+#include <fstream>
+#include <cstring>
+#include <iterator>
 
 using namespace lin_alg;
 using namespace graph;
@@ -19,6 +45,40 @@ void test_rb_tree();
 void test_graphs();
 void test_vector();
 void test_SLE_Algs();
+void test_path_policies();
+void test_contraction_hierarchy();
+void test_delta_stepping();
+void bench_delta_stepping();
+void test_bellman_ford_variants();
+void test_all_pairs();
+void test_shortest_path_tree();
+void test_multi_source_bfs();
+void test_connected_components();
+void test_scc_and_topological_sort();
+void test_spanning_tree();
+void test_binary_graph_file();
+void test_edge_list_import();
+void test_reordering();
+void bench_reordering();
+void test_compressed_graph();
+void test_incremental_shortest_paths();
+void test_path_cache();
+void test_batch_queries();
+void bench_batch_queries();
+void test_traversal_workspace();
+void bench_traversal_workspace();
+void test_pagerank();
+void bench_pagerank();
+void test_betweenness();
+void test_max_flow();
+void bench_max_flow();
+void test_grid_graph();
+void bench_grid_graph();
+void test_versioned_graph();
+void test_lsm_graph();
+void bench_lsm_graph();
+void test_edge_relaxation();
+void bench_edge_relaxation();
 
 int main()
 {
@@ -247,4 +307,1692 @@ void test_rb_tree()
 	rbm.remove(9);
 	rbm.printTree();
 	std::cout << rbm.find(3) << "\n\n";
-}
\ No newline at end of file
+}
+
+void test_path_policies()
+{
+	WGraph<unsigned int, int> wg;
+	for (int i = 0; i < 200; ++i)
+	{
+		wg.addEdge(i, (i * 7 + 3) % 200, 1 + (i * 13) % 17);
+		wg.addEdge(i, (i * 11 + 5) % 200, 1 + (i * 29) % 23);
+		wg.addEdge((i + 1) % 200, i, 40);
+	}
+	wg.addEdge(500, 501, 1); // unreachable island
+
+	ALTHeuristic<unsigned int, int> alt(wg, 8);
+	assert(alt.getLandmarks().size() > 1);
+
+	for (int to = 0; to < 200; to += 7)
+	{
+		auto expected = Dijkstra<unsigned int, int>(0, wg)[to];
+		auto bidir = findPath(0, to, wg, SearchPolicy::Bidirectional);
+		auto astar = findPath(0, to, wg, SearchPolicy::AStar);
+		auto landmarks = findPath(0, to, wg, SearchPolicy::AStar, alt);
+		assert(bidir.second == expected);
+		assert(astar.second == expected);
+		assert(landmarks.second == expected);
+		assert(bidir.first.front() == 0 && bidir.first.back() == to);
+		assert(landmarks.first.front() == 0 && landmarks.first.back() == to);
+	}
+
+	auto none = findPath(0, 501, wg, SearchPolicy::Bidirectional);
+	assert(none.first.empty());
+	none = findPath(0, 501, wg, SearchPolicy::AStar, alt);
+	assert(none.first.empty());
+
+	std::cout << "Path policy tests passed!" << std::endl;
+}
+
+void test_contraction_hierarchy()
+{
+	WGraph<unsigned int, int> wg;
+	for (int i = 0; i < 300; ++i)
+	{
+		wg.addEdge(i, (i * 7 + 3) % 300, 1 + (i * 13) % 17);
+		wg.addEdge(i, (i * 11 + 5) % 300, 1 + (i * 29) % 23);
+		wg.addEdge((i + 1) % 300, i, 1 + (i * 5) % 31);
+	}
+	wg.addEdge(1000, 1001, 1);
+
+	ContractionHierarchy<unsigned int, int> built(wg);
+	std::stringstream						stream;
+	built.save(stream);
+	auto ch = ContractionHierarchy<unsigned int, int>::load(stream);
+
+	// truncated and corrupted files are rejected before any query can read out of bounds
+	std::string bytes = stream.str();
+	auto		rejects = [](const std::string& data) {
+		std::stringstream corrupt(data);
+		try
+		{
+			ContractionHierarchy<unsigned int, int>::load(corrupt);
+		}
+		catch (const std::runtime_error&)
+		{
+			return true;
+		}
+		return false;
+	};
+	auto patched = [&](size_t position, auto value) {
+		std::string data = bytes;
+		std::memcpy(&data[position], &value, sizeof(value));
+		return data;
+	};
+	size_t n = ch.getNodesCount();
+	size_t ids_pos = 5 * sizeof(uint32_t) + sizeof(uint64_t);
+	size_t up_offsets_pos = ids_pos + n * sizeof(int) + sizeof(uint64_t);
+	size_t up_arcs_pos = up_offsets_pos + (n + 1) * sizeof(size_t) + sizeof(uint64_t);
+	assert(!rejects(bytes));
+	assert(rejects(bytes.substr(0, bytes.size() / 2)));
+	assert(rejects(patched(ids_pos - sizeof(uint64_t), uint64_t(1) << 60)));
+	assert(rejects(patched(up_offsets_pos + n * sizeof(size_t), size_t(1) << 20)));
+	assert(rejects(patched(up_offsets_pos + sizeof(size_t), size_t(1) << 20)));
+	assert(rejects(patched(up_arcs_pos, uint32_t(n))));
+	assert(rejects(patched(up_arcs_pos + sizeof(uint32_t) + sizeof(unsigned int), uint32_t(n + 5))));
+	assert(rejects(patched(4 * sizeof(uint32_t), uint32_t(2))));
+
+	ContractionHierarchy<unsigned int, int>::Query query(ch);
+	for (int from = 0; from < 300; from += 37)
+	{
+		auto costs = Dijkstra<unsigned int, int>(from, wg);
+		for (int to = 0; to < 300; to += 11)
+		{
+			auto res = query.findPath(from, to);
+			assert(res.second == costs[to]);
+			assert(res.first.front() == from && res.first.back() == to);
+
+			unsigned int length = 0;
+			for (size_t i = 1; i < res.first.size(); ++i)
+			{
+				unsigned int best = std::numeric_limits<unsigned int>::max();
+				auto		 range = wg.edges_to.equal_range(res.first[i - 1]);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					if (it->second.second == res.first[i])
+					{
+						best = std::min(best, it->second.first);
+					}
+				}
+				length += best;
+			}
+			assert(length == res.second);
+		}
+	}
+	assert(query.findPath(0, 1001).first.empty());
+
+	std::cout << "Contraction hierarchy tests passed!" << std::endl;
+}
+
+WGraph<unsigned int, int> makeRandomGraph(int nodes, int edges_per_node, unsigned int max_weight, unsigned int seed = 42)
+{
+	std::mt19937							  rng(seed);
+	std::uniform_int_distribution<int>		  node_dist(0, nodes - 1);
+	std::uniform_int_distribution<unsigned int> weight_dist(1, max_weight);
+
+	WGraph<unsigned int, int> g;
+	for (int i = 0; i < nodes; ++i)
+	{
+		for (int j = 0; j < edges_per_node; ++j)
+		{
+			g.addEdge(i, node_dist(rng), weight_dist(rng));
+		}
+	}
+	return g;
+}
+
+void test_delta_stepping()
+{
+	auto g = makeRandomGraph(2000, 4, 100);
+	g.addEdge(5000, 5001, 1);
+
+	auto expected = Dijkstra<unsigned int, int>(0, g);
+	for (unsigned int delta : { 1u, 7u, 50u, 1000u })
+	{
+		for (size_t threads : { 1, 4 })
+		{
+			auto res = DeltaStepping(0, g, delta, threads);
+			assert(res == expected);
+		}
+	}
+
+	// a long path spans far more buckets than the ring holds
+	WGraph<unsigned int, int> line;
+	for (int i = 0; i < 20000; ++i)
+	{
+		line.addEdge(i, i + 1, 100);
+		line.addEdge(i, i + 2, 250);
+	}
+	assert((DeltaStepping(0, line, 1u, 2) == Dijkstra<unsigned int, int>(0, line)));
+
+	// a throwing worker surfaces in the caller, and the pool stays usable afterwards
+	parallel::ThreadPool pool(4);
+	for (size_t failing : { 0, 3 })
+	{
+		bool thrown = false;
+		try
+		{
+			pool.runOnAll([&](size_t worker) {
+				if (worker == failing)
+				{
+					throw std::runtime_error("worker failed");
+				}
+			});
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	std::atomic<size_t> visited(0);
+	pool.parallelFor(1000, [&](size_t begin, size_t end, size_t) { visited += end - begin; });
+	assert(visited == 1000);
+
+	std::cout << "Delta-stepping tests passed!" << std::endl;
+}
+
+void bench_delta_stepping()
+{
+	auto g = makeRandomGraph(200000, 8, 1000);
+	auto csr = toCSR(g);
+
+	auto start = std::chrono::steady_clock::now();
+	auto expected = Dijkstra<unsigned int, int>(0, g);
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Dijkstra (sequential): " << elapsed << " ms\n";
+
+	size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		parallel::ThreadPool pool(threads);
+		for (unsigned int delta : { 50u, 200u, 1000u })
+		{
+			start = std::chrono::steady_clock::now();
+			auto res = DeltaStepping(csr.getIndex(0), csr, delta, pool);
+			elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			for (size_t i = 0; i < res.size(); ++i)
+			{
+				assert(res[i] == expected[csr.ids[i]]);
+			}
+			std::cout << "Delta-stepping threads=" << threads << " delta=" << delta << ": " << elapsed << " ms\n";
+		}
+	}
+}
+
+void test_bellman_ford_variants()
+{
+	WGraph<int, int> dag;
+	for (int i = 0; i < 200; ++i)
+	{
+		dag.addEdge(i, i + 1, (i % 5) - 2);
+		dag.addEdge(i, i + 3, (i % 7) - 1);
+	}
+	dag.addEdge(1000, 1001, -1); // unreachable nodes must not look like a negative cycle
+	auto expected = Bellman_Ford<int, int>(0, dag);
+	assert(SPFA(0, dag) == expected);
+	assert(ParallelBellmanFord(0, dag, 1) == expected);
+	assert(ParallelBellmanFord(0, dag, 4) == expected);
+
+	WGraph<int, int> cycle;
+	cycle.addEdge(0, 1, 1);
+	cycle.addEdge(1, 2, -3);
+	cycle.addEdge(2, 1, 1);
+	for (int variant = 0; variant < 2; ++variant)
+	{
+		bool thrown = false;
+		try
+		{
+			variant == 0 ? SPFA(0, cycle) : ParallelBellmanFord(0, cycle, 2);
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	std::cout << "Bellman-Ford variant tests passed!" << std::endl;
+}
+
+void test_all_pairs()
+{
+	WGraph<int, int> g;
+	for (int i = 0; i < 150; ++i)
+	{
+		g.addEdge(i, (i * 7 + 3) % 150, (i * 13) % 17);
+		g.addEdge(i, i + 1, (i % 5) - 1);
+		g.addEdge((i * 11 + 2) % 150, i, 9);
+	}
+	g.addEdge(1000, 1001, 4);
+
+	auto fw = FloydWarshall(g, true, 2);
+	auto johnson = Johnson(g, true, 2);
+	for (int from : { 0, 17, 149, 1000 })
+	{
+		auto expected = Bellman_Ford<int, int>(from, g);
+		for (auto& [to, d] : expected)
+		{
+			assert(fw.getDistance(from, to) == d);
+			assert(johnson.getDistance(from, to) == d);
+			for (auto* m : { &fw, &johnson })
+			{
+				auto path = m->getPath(from, to);
+				int	 length = 0;
+				for (size_t i = 1; i < path.size(); ++i)
+				{
+					int	 best = std::numeric_limits<int>::max();
+					auto range = g.edges_to.equal_range(path[i - 1]);
+					for (auto it = range.first; it != range.second; ++it)
+					{
+						if (it->second.second == path[i])
+						{
+							best = std::min(best, it->second.first);
+						}
+					}
+					length += best;
+				}
+				assert(path.empty() ? d == std::numeric_limits<int>::max() : length == d);
+			}
+		}
+	}
+
+	std::cout << "All-pairs tests passed!" << std::endl;
+}
+
+void test_shortest_path_tree()
+{
+	WGraph<unsigned int, int> wg;
+	wg.addEdge(0, 1, 0);
+	wg.addEdge(1, 2, 0);
+	wg.addEdge(2, 0, 0); // zero-weight cycle
+	wg.addEdge(2, 3, 5);
+	wg.addEdge(0, 3, 7);
+	wg.addEdge(4, 3, 1); // 4 is unreachable from 0
+
+	auto tree = getShortestPathTree(0, wg);
+	assert(tree.getCost(3) == 5);
+	assert((tree.getPath(3) == std::vector<int> { 0, 1, 2, 3 }));
+	assert(tree.getPath(0) == std::vector<int>(1, 0));
+	assert(!tree.isReachable(4) && tree.getPath(4).empty());
+
+	auto none = findPath(0, 4, wg);
+	assert(none.first.empty() && none.second == std::numeric_limits<unsigned int>::max());
+
+	WGraph<int, int> signed_graph;
+	signed_graph.addEdge(0, 1, 1);
+	signed_graph.addEdge(0, 2, 4);
+	signed_graph.addEdge(1, 2, -2);
+	signed_graph.addEdge(1, 3, 3);
+	signed_graph.addEdge(2, 3, 2);
+	auto res = findPath(0, 3, signed_graph);
+	assert(res.second == 1);
+	assert((res.first == std::vector<int> { 0, 1, 2, 3 }));
+
+	std::cout << "Shortest-path tree tests passed!" << std::endl;
+}
+
+void test_multi_source_bfs()
+{
+	UGraph<int> ug;
+	for (int i = 0; i < 500; ++i)
+	{
+		ug.addEdge(i, (i * 7 + 3) % 500);
+		ug.addEdge(i, (i * 13 + 1) % 600);
+	}
+
+	std::vector<int> sources;
+	for (int i = 0; i < 300; i += 2)
+	{
+		sources.push_back(i);
+	}
+	auto res = MultiSourceBFS<2>(ug, sources);
+	auto csr = toCSR(ug);
+
+	for (size_t s = 0; s < sources.size(); ++s)
+	{
+		std::vector<uint32_t> expected(csr.getNodesCount(), unreachable_hops);
+		std::deque<uint32_t>  fifo(1, csr.getIndex(sources[s]));
+		expected[fifo.front()] = 0;
+		while (!fifo.empty())
+		{
+			uint32_t u = fifo.front();
+			fifo.pop_front();
+			for (size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+			{
+				if (expected[csr.targets[e]] == unreachable_hops)
+				{
+					expected[csr.targets[e]] = expected[u] + 1;
+					fifo.push_back(csr.targets[e]);
+				}
+			}
+		}
+		assert(res[s] == expected);
+	}
+
+	std::cout << "Multi-source BFS tests passed!" << std::endl;
+}
+
+void test_connected_components()
+{
+	UGraph<int> ug;
+	for (int i = 0; i < 3000; ++i)
+	{
+		ug.addEdge(i, (i * 37 + 11) % 2000); // one big component over 0..1999
+	}
+	for (int i = 3000; i < 3100; i += 2)
+	{
+		ug.addEdge(i + 1, i); // pairs
+	}
+	ug.addEdge(5000, 5000); // singleton with a loop
+
+	auto	   csr = toCSR(ug);
+	UnionFind	 uf(csr.getNodesCount());
+	for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+	{
+		for (size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+		{
+			uf.unite(u, csr.targets[e]);
+		}
+	}
+
+	parallel::ThreadPool pool(4);
+	auto				 afforest = ConnectedComponents(ug, 4);
+	auto				 linked = ConnectedComponents(toEdgeList(csr), pool);
+	for (auto* comps : { &afforest, &linked })
+	{
+		assert(comps->getComponentsCount() == uf.getSetsCount());
+		for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+		{
+			for (uint32_t v : { 0u, u / 2, u - (u > 0) })
+			{
+				assert((comps->labels[u] == comps->labels[v]) == uf.connected(u, v));
+			}
+		}
+	}
+
+	auto histogram = afforest.getSizeHistogram();
+	assert(histogram[2] == 50 && histogram[1] == 1);
+	assert(afforest.getLabel(3001) == afforest.getLabel(3000));
+
+	std::cout << "Connected components tests passed!" << std::endl;
+}
+
+void test_scc_and_topological_sort()
+{
+	// a long chain would overflow a recursive DFS
+	WGraph<int, int> chain;
+	for (int i = 0; i < 200000; ++i)
+	{
+		chain.addEdge(i, i + 1, 1);
+	}
+	chain.addEdge(200000, 0, 1);
+	assert(TarjanSCC(chain).getComponentsCount() == 1);
+
+	WGraph<int, int> g;
+	g.addEdge(0, 1, 2);
+	g.addEdge(1, 2, 2);
+	g.addEdge(2, 0, 2); // {0, 1, 2}
+	g.addEdge(2, 3, -5);
+	g.addEdge(1, 3, 4);
+	g.addEdge(3, 4, 1);
+	g.addEdge(4, 3, 1); // {3, 4}
+	g.addEdge(4, 5, -2); // {5}
+	g.addEdge(0, 5, 1);
+
+	auto scc = TarjanSCC(g);
+	assert(scc.getComponentsCount() == 3);
+	assert(scc.getLabel(0) == scc.getLabel(2) && scc.getLabel(3) == scc.getLabel(4));
+	assert(scc.getLabel(0) < scc.getLabel(3) && scc.getLabel(3) < scc.getLabel(5));
+	assert(scc.dag.getEdgesCount() == 3);
+
+	auto dist = DAGShortestPaths(scc.getLabel(0), scc.dag);
+	assert(dist[scc.getLabel(3)] == -5 && dist[scc.getLabel(5)] == -7);
+
+	WGraph<int, int> dag;
+	dag.addEdge(5, 2, 1);
+	dag.addEdge(5, 0, 1);
+	dag.addEdge(4, 0, 1);
+	dag.addEdge(4, 1, 1);
+	dag.addEdge(2, 3, 1);
+	dag.addEdge(3, 1, 1);
+	auto order = TopologicalSort(dag);
+	std::unordered_map<int, size_t> position;
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		position[order[i]] = i;
+	}
+	for (auto& [from, edge] : dag.edges_to)
+	{
+		assert(position[from] < position[edge.second]);
+	}
+
+	bool thrown = false;
+	try
+	{
+		TopologicalSort(g);
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	std::cout << "SCC and topological sort tests passed!" << std::endl;
+}
+
+void test_spanning_tree()
+{
+	WGraph<int, int> g;
+	for (int i = 0; i < 3000; ++i)
+	{
+		g.addEdge(i, (i * 37 + 11) % 2500, (i * 13) % 101 - 50);
+		g.addEdge((i * 7 + 1) % 2500, i, (i * 29) % 67 - 20);
+	}
+	g.addEdge(9000, 9001, 3); // second tree of the forest
+
+	auto kruskal = Kruskal(g, 4);
+	auto boruvka = Boruvka(g, 4);
+	auto components = ConnectedComponents(g, 1);
+	assert(kruskal.edges.size() == g.getNodesCount() - components.getComponentsCount());
+	assert(boruvka.edges.size() == kruskal.edges.size());
+	assert(boruvka.total_weight == kruskal.total_weight);
+
+	// ties are broken by edge position in both, so the forests are the same edge set, and the
+	// parallel rounds give the same order whatever the thread count
+	auto edgeSet = [](const SpanningTree<int, int>& tree) {
+		std::vector<std::tuple<int, int, int>> res;
+		for (auto& e : tree.edges)
+		{
+			res.emplace_back(std::min(e.from, e.to), std::max(e.from, e.to), e.weight);
+		}
+		std::sort(res.begin(), res.end());
+		return res;
+	};
+	assert(edgeSet(boruvka) == edgeSet(kruskal));
+	auto sequential = Boruvka(g, 1);
+	for (size_t i = 0; i < boruvka.edges.size(); ++i)
+	{
+		assert(sequential.edges[i].from == boruvka.edges[i].from && sequential.edges[i].to == boruvka.edges[i].to);
+	}
+
+	WGraph<unsigned int, int> small;
+	small.addEdge(0, 1, 4);
+	small.addEdge(1, 2, 1);
+	small.addEdge(2, 0, 2);
+	small.addEdge(2, 3, 7);
+	assert(Kruskal(small, 1).total_weight == 10);
+	assert(Boruvka(small, 2).total_weight == 10);
+
+	std::cout << "Spanning tree tests passed!" << std::endl;
+}
+
+void test_binary_graph_file()
+{
+	auto g = makeRandomGraph(5000, 6, 100);
+	g.addEdge(-7, 3, 2);
+	auto csr = toCSR(g);
+	writeBinaryGraph(csr, "test_graph.bin");
+
+	{
+		MappedGraph<unsigned int, int> mapped("test_graph.bin");
+		assert(mapped.getNodesCount() == csr.getNodesCount());
+		assert(mapped.getEdgesCount() == csr.getEdgesCount());
+		assert(mapped.getIndex(-7) == csr.getIndex(-7));
+		assert(mapped.ids[mapped.getIndex(4999)] == 4999);
+
+		uint32_t from = mapped.getIndex(0);
+		assert(BFSDistances(from, mapped) == BFSDistances(from, csr));
+		assert(DFSOrder(from, mapped) == DFSOrder(from, csr));
+		auto dist = DijkstraDistances(from, mapped);
+		auto expected = Dijkstra<unsigned int, int>(0, g);
+		for (uint32_t u = 0; u < dist.size(); ++u)
+		{
+			assert(dist[u] == expected[mapped.ids[u]]);
+		}
+	}
+
+	bool thrown = false;
+	try
+	{
+		MappedGraph<float, int> wrong_type("test_graph.bin");
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	// truncated and corrupted files are rejected before any array is exposed
+	std::string bytes;
+	{
+		std::ifstream in("test_graph.bin", std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	BinaryGraphHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	auto rejects = [](const std::string& data) {
+		{
+			std::ofstream out("test_graph_bad.bin", std::ios::binary | std::ios::trunc);
+			out.write(data.data(), static_cast<std::streamsize>(data.size()));
+		}
+		bool rejected = false;
+		try
+		{
+			MappedGraph<unsigned int, int> bad("test_graph_bad.bin");
+		}
+		catch (const std::runtime_error&)
+		{
+			rejected = true;
+		}
+		return rejected;
+	};
+	assert(rejects(bytes.substr(0, header.targets_pos + 8)));
+	std::string corrupted = bytes;
+	uint64_t	too_many = header.edges + 1;
+	std::memcpy(&corrupted[header.offsets_pos + header.nodes * sizeof(uint64_t)], &too_many, sizeof(too_many));
+	assert(rejects(corrupted));
+	corrupted = bytes;
+	uint64_t backwards = header.edges;
+	std::memcpy(&corrupted[header.offsets_pos + sizeof(uint64_t)], &backwards, sizeof(backwards));
+	assert(rejects(corrupted));
+	corrupted = bytes;
+	uint32_t bad_target = uint32_t(header.nodes);
+	std::memcpy(&corrupted[header.targets_pos], &bad_target, sizeof(bad_target));
+	assert(rejects(corrupted));
+	assert(!rejects(bytes));
+	std::remove("test_graph_bad.bin");
+	std::remove("test_graph.bin");
+
+	std::cout << "Binary graph file tests passed!" << std::endl;
+}
+
+void test_edge_list_import()
+{
+	std::stringstream text;
+	text << "# comment line\n% another\n";
+	WGraph<int, int> expected;
+	for (int i = 0; i < 20000; ++i)
+	{
+		int from = (i * 7919) % 3001 - 500, to = 123456789 + (i * 31) % 1000, weight = (i * 13) % 41 - 20;
+		expected.addEdge(from, to, weight);
+		text << from << (i % 2 ? "\t" : " ") << to << " " << weight << (i % 3 ? "\n" : "\r\n");
+	}
+	text << "7 8 5\n7 8 -3\n7 8 9"; // parallel edges, last line without newline
+	expected.addEdge(7, 8, 5);
+	expected.addEdge(7, 8, -3);
+	expected.addEdge(7, 8, 9);
+
+	EdgeListImportOptions options;
+	options.chunk_bytes = 1 << 16;
+	options.threads = 3;
+	std::string input = text.str();
+
+	std::stringstream first(input);
+	auto			  csr = importEdgeList<int, int>(first, options);
+	auto			  reference = toCSR(expected);
+	assert(csr.ids == reference.ids);
+	assert(csr.getEdgesCount() == reference.getEdgesCount());
+	for (uint32_t u = 0; u < csr.getNodesCount(); ++u)
+	{
+		std::multiset<std::pair<uint32_t, int>> a, b;
+		csr.forEachNeighbour(u, [&](uint32_t v, int w) { a.insert({ v, w }); });
+		reference.forEachNeighbour(u, [&](uint32_t v, int w) { b.insert({ v, w }); });
+		assert(a == b);
+	}
+
+	for (auto policy : { ParallelEdges::KeepMinWeight, ParallelEdges::KeepFirst })
+	{
+		options.parallel_edges = policy;
+		std::stringstream again(input);
+		auto			  deduped = importEdgeList<int, int>(again, options);
+		size_t			  to_eight = 0;
+		deduped.forEachNeighbour(deduped.getIndex(7), [&](uint32_t v, int w) {
+			if (deduped.ids[v] == 8)
+			{
+				++to_eight;
+				assert(w == (policy == ParallelEdges::KeepFirst ? 5 : -3));
+			}
+		});
+		assert(to_eight == 1);
+	}
+
+	options.weighted = false;
+	std::stringstream unweighted_input(input);
+	auto			  unweighted = importEdgeList<unsigned int, int>(unweighted_input, options);
+	assert(unweighted.weights.empty() && unweighted.ids == reference.ids);
+
+	// a malformed line raises the same error whether or not it is parsed on a worker thread
+	options.weighted = true;
+	auto rejects = [&](const std::string& bad_line, auto vertex) {
+		std::string text = input;
+		text.insert(text.find('\n', text.size() / 2) + 1, bad_line);
+		for (size_t threads : { 1, 3 })
+		{
+			options.threads = threads;
+			std::stringstream broken(text);
+			bool			  thrown = false;
+			try
+			{
+				importEdgeList<int, decltype(vertex)>(broken, options);
+			}
+			catch (const std::runtime_error&)
+			{
+				thrown = true;
+			}
+			if (!thrown)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	assert(rejects("12 x 3\n", 0));
+	assert(rejects("x 1 2\n", 0));
+	assert(rejects("1 2 x\n", 0));
+	assert(rejects("3000000000 5 7\n", 0));
+	assert(rejects("1 2 99999999999999999999999\n", 0));
+	assert(rejects("-1 4 2\n", 0u));
+	assert(!rejects("1 2\n   \n", 0));
+
+	// the extremes of V still fit
+	std::stringstream extremes("2147483647 -2147483648 5\n");
+	auto			  edge = importEdgeList<int, int>(extremes, options);
+	assert(edge.getIndex(std::numeric_limits<int>::max()) != edge.getIndex(std::numeric_limits<int>::min()));
+
+	std::cout << "Edge list import tests passed!" << std::endl;
+}
+
+// 2-D grid with scrambled ids: plenty of locality in the structure, none in the numbering
+CSRGraph<unsigned int, int> makeScrambledGrid(int side)
+{
+	std::vector<int> label(side * side);
+	std::iota(label.begin(), label.end(), 0);
+	std::shuffle(label.begin(), label.end(), std::mt19937(7));
+
+	std::vector<int>		  ids(side * side);
+	std::vector<uint32_t>	  sources, targets;
+	std::vector<unsigned int> weights;
+	for (int y = 0; y < side; ++y)
+	{
+		for (int x = 0; x < side; ++x)
+		{
+			for (auto [dx, dy] : { std::pair(1, 0), std::pair(-1, 0), std::pair(0, 1), std::pair(0, -1) })
+			{
+				if (x + dx >= 0 && x + dx < side && y + dy >= 0 && y + dy < side)
+				{
+					sources.push_back(label[y * side + x]);
+					targets.push_back(label[(y + dy) * side + x + dx]);
+					weights.push_back(1 + (x * 7 + y * 3) % 10);
+				}
+			}
+		}
+	}
+	std::iota(ids.begin(), ids.end(), 0);
+	return buildCSR<unsigned int, int>(ids, sources, targets, weights);
+}
+
+void test_reordering()
+{
+	auto g = makeScrambledGrid(40);
+	auto expected = DijkstraDistances(0, g);
+	for (auto method : { ReorderMethod::DegreeSort, ReorderMethod::BFS, ReorderMethod::DFS, ReorderMethod::ReverseCuthillMcKee, ReorderMethod::HubCluster })
+	{
+		auto reordered = reorder(g, method);
+		auto sorted = reordered.new_to_old;
+		std::sort(sorted.begin(), sorted.end());
+		assert(sorted == detail::identityOrder(g.getNodesCount()));
+		assert(reordered.graph.getEdgesCount() == g.getEdgesCount());
+
+		auto dist = DijkstraDistances(reordered.old_to_new[0], reordered.graph);
+		assert(reordered.toOriginalOrder(dist) == expected);
+		assert(reordered.graph.ids[reordered.old_to_new[5]] == g.ids[5]);
+	}
+
+	std::cout << "Reordering tests passed!" << std::endl;
+}
+
+void bench_reordering()
+{
+	auto g = makeScrambledGrid(1000);
+	auto time = [](auto&& run) {
+		auto start = std::chrono::steady_clock::now();
+		run();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+	auto report = [&](const char* name, const CSRGraph<unsigned int, int>& graph, uint32_t source) {
+		double bfs = time([&] { BFSDistances(source, graph); });
+		double dijkstra = time([&] { DijkstraDistances(source, graph); });
+		std::cout << name << ": BFS " << bfs << " ms, Dijkstra " << dijkstra << " ms\n";
+	};
+
+	report("original", g, 0);
+	const std::pair<const char*, ReorderMethod> methods[] = {
+		{ "degree sort", ReorderMethod::DegreeSort },
+		{ "BFS order", ReorderMethod::BFS },
+		{ "DFS order", ReorderMethod::DFS },
+		{ "RCM", ReorderMethod::ReverseCuthillMcKee },
+		{ "hub cluster", ReorderMethod::HubCluster }
+	};
+	for (auto& [name, method] : methods)
+	{
+		auto reordered = reorder(g, method);
+		report(name, reordered.graph, reordered.old_to_new[0]);
+	}
+}
+
+void test_compressed_graph()
+{
+	auto grid = reorder(makeScrambledGrid(300), ReorderMethod::BFS).graph;
+	CompressedGraph<unsigned int, int> compressed(grid);
+	double							   bytes_per_edge = double(compressed.getAdjacencyBytesCount()) / compressed.getEdgesCount();
+	assert(bytes_per_edge <= 4.0);
+	assert(compressed.getBytesCount() == compressed.getAdjacencyBytesCount() + grid.getNodesCount() * (sizeof(int) + sizeof(uint32_t)));
+
+	uint32_t source = grid.getIndex(17);
+	assert(compressed.getIndex(17) == source);
+	assert(BFSDistances(source, compressed) == BFSDistances(source, grid));
+	assert(DijkstraDistances(source, compressed) == DijkstraDistances(source, grid));
+	assert(DFSOrder(source, compressed).size() == grid.getNodesCount());
+
+	WGraph<int, int> negative;
+	negative.addEdge(5, 1, -7);
+	negative.addEdge(5, 9, 300000);
+	negative.addEdge(1, 5, 2);
+	auto csr = toCSR(negative);
+	CompressedGraph<int, int> small(csr);
+	std::vector<std::pair<int, int>> decoded;
+	small.forEachNeighbour(small.getIndex(5), [&](uint32_t v, int w) { decoded.emplace_back(small.ids[v], w); });
+	assert((decoded == std::vector<std::pair<int, int>> { { 1, -7 }, { 9, 300000 } }));
+
+	bool thrown = false;
+	try
+	{
+		small.getIndex(4);
+	}
+	catch (const std::out_of_range&)
+	{
+		thrown = true;
+	}
+	assert(thrown && small.getIndex(9) == csr.getIndex(9));
+
+	std::cout << "Compressed graph tests passed! (" << bytes_per_edge << " adjacency bytes per edge, "
+			  << double(compressed.getBytesCount()) / compressed.getEdgesCount() << " with ids)" << std::endl;
+}
+
+void test_incremental_shortest_paths()
+{
+	auto					   g = makeRandomGraph(1000, 3, 100);
+	IncrementalShortestPaths<> sssp(g);
+	std::vector<int>		   sources { 0, 17, 500 };
+	for (int s : sources)
+	{
+		sssp.addSource(s);
+	}
+
+	std::mt19937							rng(7);
+	std::uniform_int_distribution<int>		node(0, 1099);
+	std::uniform_int_distribution<unsigned> weight(1, 100);
+	for (int i = 0; i < 300; ++i)
+	{
+		sssp.addEdge(node(rng), node(rng), weight(rng));
+	}
+	for (int i = 0; i < 50; ++i)
+	{
+		auto it = std::next(g.edges_to.begin(), node(rng) % g.edges_to.size());
+		sssp.decreaseWeight(it->first, it->second.second, it->second.first / 2);
+	}
+
+	for (int s : sources)
+	{
+		auto& tree = sssp.getTree(s);
+		auto  expected = Dijkstra(s, g);
+		for (auto v : g.nodes)
+		{
+			assert(tree.getCost(v) == expected[v]);
+			auto path = tree.getPath(v);
+			assert(path.empty() == !tree.isReachable(v));
+			unsigned int cost = 0;
+			for (size_t k = 1; k < path.size(); ++k)
+			{
+				unsigned int w = std::numeric_limits<unsigned int>::max();
+				bool		 found = false;
+				auto		 range = g.edges_to.equal_range(path[k - 1]);
+				for (auto e = range.first; e != range.second; ++e)
+				{
+					if (e->second.second == path[k] && e->second.first <= w)
+					{
+						w = e->second.first;
+						found = true;
+					}
+				}
+				assert(found);
+				cost += w;
+			}
+			assert(path.empty() || cost == expected[v]);
+		}
+	}
+
+	// a shortcut far from the source only touches the nodes it improves
+	WGraph<int, int> line;
+	for (int i = 0; i < 100; ++i)
+	{
+		line.addEdge(i, i + 1, 1);
+	}
+	IncrementalShortestPaths<int, int> line_sssp(line);
+	line_sssp.addSource(0);
+	assert(line_sssp.addEdge(90, 95, 1) == 6);
+	assert(line_sssp.getTree(0).getCost(100) == 96);
+	assert(line_sssp.addEdge(0, 50, 100) == 0);
+
+	// rejected edges leave the graph and every tree as they were
+	line_sssp.addSource(50);
+	auto tree_before = line_sssp.getTree(0).costs;
+	auto edges_before = line.edges_to.size();
+	auto version_before = line.version;
+	for (auto [from, to, weight] : { std::tuple(95, 90, -10), std::tuple(3, 3, -1), std::tuple(60, 55, -10) })
+	{
+		bool thrown = false;
+		try
+		{
+			line_sssp.addEdge(from, to, weight);
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+		assert(line_sssp.getTree(0).costs == tree_before && line.edges_to.size() == edges_before && line.version == version_before);
+		assert(line_sssp.getTree(0).getPath(3).size() == 4 && line_sssp.getTree(0).getCost(3) == 3);
+	}
+	bool thrown = false;
+	try
+	{
+		line_sssp.decreaseWeight(92, 93, -10);
+		line_sssp.addEdge(93, 92, 5);
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	assert(thrown && line_sssp.getTree(50).getCost(93) == 32 && line_sssp.getTree(50).getCost(92) == 42);
+
+	std::cout << "Incremental shortest-path tests passed!" << std::endl;
+}
+
+void test_path_cache()
+{
+	auto							   g = makeRandomGraph(500, 3, 100);
+	ShortestPathCache<>				   cache(g);
+	std::mt19937					   rng(3);
+	std::uniform_int_distribution<int> node(0, 499);
+	for (int i = 0; i < 200; ++i)
+	{
+		int	 from = node(rng) % 10, to = node(rng);
+		auto res = cache.findPath(from, to);
+		assert(res == findPath(from, to, g));
+	}
+	assert(cache.getMisses() == 10 && cache.getHits() == 190);
+	assert(cache.getHitRate() == 0.95);
+
+	g.addEdge(0, 499, 0);
+	assert(cache.findPath(0, 499).second == 0);
+	assert(cache.getInvalidations() == 1 && cache.getCachedCount() == 1);
+
+	// room for about two trees: the least recently used one goes first
+	ShortestPathCache<> small(g, cache.getBytesCount() * 5 / 2);
+	small.getTree(1);
+	small.getTree(2);
+	small.getTree(1);
+	small.getTree(3);
+	assert(small.getEvictions() == 1 && small.getCachedCount() == 2);
+	small.getTree(1);
+	assert(small.getHits() == 2);
+	small.getTree(2);
+	assert(small.getMisses() == 4);
+
+	std::cout << "Path cache tests passed!" << std::endl;
+}
+
+void test_batch_queries()
+{
+	auto							   g = makeRandomGraph(1000, 3, 100);
+	std::mt19937					   rng(11);
+	std::uniform_int_distribution<int> node(0, 1099);
+	std::vector<std::pair<int, int>>   queries;
+	for (int i = 0; i < 2000; ++i)
+	{
+		queries.emplace_back(node(rng) % 40, node(rng));
+	}
+	queries.emplace_back(5, 5);
+	queries.emplace_back(-1, 3);
+	queries.emplace_back(queries.front());
+
+	auto res = BatchShortestPaths(g, queries, 4);
+	assert(res.size() == queries.size());
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		auto expected = findPath(queries[i].first, queries[i].second, g);
+		assert(res[i].second == expected.second);
+		assert(res[i].first.empty() == expected.first.empty());
+		if (!res[i].first.empty())
+		{
+			assert(res[i].first.front() == queries[i].first && res[i].first.back() == queries[i].second);
+		}
+	}
+	assert(res.back() == res.front());
+
+	std::cout << "Batch query tests passed!" << std::endl;
+}
+
+void bench_batch_queries()
+{
+	auto							   g = makeRandomGraph(100000, 8, 1000);
+	auto							   csr = toCSR(g);
+	std::mt19937					   rng(5);
+	std::uniform_int_distribution<int> node(0, 99999);
+	std::vector<std::pair<int, int>>   queries;
+	for (int i = 0; i < 10000; ++i)
+	{
+		queries.emplace_back(node(rng) % 100, node(rng));
+	}
+
+	for (size_t threads : { size_t(1), size_t(2), size_t(4) })
+	{
+		parallel::ThreadPool pool(threads);
+		auto				 start = std::chrono::steady_clock::now();
+		auto				 res = BatchShortestPaths(csr, queries, pool);
+		auto				 ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		std::cout << threads << " threads: " << res.size() << " queries in " << ms << " ms" << std::endl;
+	}
+}
+
+void test_traversal_workspace()
+{
+	auto						 csr = toCSR(makeRandomGraph(2000, 3, 100));
+	TraversalWorkspace<>		 ws;
+	TraversalWorkspace<uint32_t> hops;
+	for (uint32_t from = 0; from < 50; ++from)
+	{
+		auto bfs = BFSDistances(from, csr);
+		assert(BFSSearch(from, csr, hops));
+		for (uint32_t v = 0; v < csr.getNodesCount(); ++v)
+		{
+			assert(hops.getDist(v) == bfs[v]);
+		}
+		assert(DFSSearch(from, csr, hops));
+		assert(hops.getOrder() == DFSOrder(from, csr));
+
+		auto dist = DijkstraDistances(from, csr);
+		assert(DijkstraSearch(from, csr, ws));
+		for (uint32_t v = 0; v < csr.getNodesCount(); ++v)
+		{
+			assert(ws.getDist(v) == dist[v]);
+		}
+
+		// early exit keeps the target's cost and a path of matching length
+		uint32_t to = (from * 37 + 11) % csr.getNodesCount();
+		bool	 found = DijkstraSearch(from, csr, ws, to);
+		assert(found == (dist[to] != std::numeric_limits<unsigned int>::max()));
+		assert(ws.getDist(to) == dist[to]);
+		auto	 path = ws.getPath(to);
+		unsigned cost = 0;
+		for (size_t i = 1; i < path.size(); ++i)
+		{
+			unsigned best = std::numeric_limits<unsigned>::max();
+			csr.forEachNeighbour(path[i - 1], [&](uint32_t v, unsigned w) {
+				if (v == path[i])
+				{
+					best = std::min(best, w);
+				}
+			});
+			cost += best;
+		}
+		assert(!found || (path.front() == from && path.back() == to && cost == dist[to]));
+
+		found = BFSSearch(from, csr, hops, to);
+		assert(found == (bfs[to] != unreachable_hops) && hops.getDist(to) == bfs[to]);
+		assert(!found || hops.getPath(to).size() == bfs[to] + 1);
+	}
+
+	std::cout << "Traversal workspace tests passed!" << std::endl;
+}
+
+void bench_traversal_workspace()
+{
+	auto							   g = makeRandomGraph(200000, 4, 1000);
+	auto							   csr = toCSR(g);
+	std::mt19937					   rng(9);
+	std::uniform_int_distribution<int> node(0, 199999);
+	std::vector<std::pair<int, int>>   queries;
+	for (int i = 0; i < 1000; ++i)
+	{
+		queries.emplace_back(node(rng), node(rng));
+	}
+
+	// short queries: the target is a two-hop neighbour of the source
+	for (auto& [from, to] : queries)
+	{
+		auto range = g.edges_to.equal_range(from);
+		if (range.first != range.second)
+		{
+			auto next = g.edges_to.equal_range(range.first->second.second);
+			to = next.first != next.second ? next.first->second.second : range.first->second.second;
+		}
+	}
+
+	auto	 start = std::chrono::steady_clock::now();
+	unsigned checksum = 0;
+	for (size_t i = 0; i < 20; ++i)
+	{
+		checksum += findPath(queries[i].first, queries[i].second, g).second;
+	}
+	auto findpath_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / 20;
+
+	TraversalWorkspace<> ws(csr.getNodesCount());
+	start = std::chrono::steady_clock::now();
+	for (auto& [from, to] : queries)
+	{
+		DijkstraSearch(csr.getIndex(from), csr, ws, csr.getIndex(to));
+		checksum += ws.getDist(csr.getIndex(to));
+	}
+	auto workspace_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / queries.size();
+	std::cout << "short query: findPath " << findpath_ms << " ms, workspace Dijkstra " << workspace_ms << " ms (" << checksum << ")" << std::endl;
+}
+
+void test_pagerank()
+{
+	// 0 -> 1 -> 2 -> 0 cycle with 3 pointing into it and 4 dangling
+	WGraph<unsigned int, int> g;
+	g.addEdge(0, 1, 1);
+	g.addEdge(1, 2, 1);
+	g.addEdge(2, 0, 1);
+	g.addEdge(3, 0, 1);
+	g.addEdge(2, 4, 3);
+
+	// reference: plain power iteration on the dense transition matrix
+	auto				csr = toCSR(g);
+	size_t				n = csr.getNodesCount();
+	std::vector<double> expected(n, 1.0 / n);
+	for (int iteration = 0; iteration < 200; ++iteration)
+	{
+		std::vector<double> next(n, 0.15 / n);
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			size_t degree = csr.offsets[u + 1] - csr.offsets[u];
+			for (uint32_t v = 0; v < n; ++v)
+			{
+				next[v] += degree ? 0.0 : 0.85 * expected[u] / n;
+			}
+			csr.forEachNeighbour(u, [&](uint32_t v, unsigned) { next[v] += 0.85 * expected[u] / degree; });
+		}
+		expected = next;
+	}
+
+	for (size_t threads : { size_t(1), size_t(3) })
+	{
+		auto   ranks = PageRank(g, PageRankOptions(), threads);
+		double sum = 0;
+		for (uint32_t u = 0; u < n; ++u)
+		{
+			assert(std::abs(ranks.scores[u] - expected[u]) < 1e-7);
+			sum += ranks.scores[u];
+		}
+		assert(std::abs(sum - 1.0) < 1e-9);
+		assert(ranks.residuals.size() == ranks.iteration_ms.size() && ranks.residuals.back() < 1e-9);
+	}
+
+	PageRankOptions weighted;
+	weighted.weighted = true;
+	auto by_weight = PageRank(g, weighted);
+	assert(by_weight.getScore(4) > PageRank(g).getScore(4));
+
+	auto personal = PersonalizedPageRank(g, std::vector<int> { 3 });
+	assert(personal.getScore(3) > 0.15 - 1e-9 && personal.getScore(3) > 3 * PageRank(g).getScore(3));
+
+	auto degree = DegreeCentrality(g);
+	assert(degree.getScore(2) == 4 && degree.getScore(4) == 0);
+
+	std::cout << "PageRank tests passed!" << std::endl;
+}
+
+void bench_pagerank()
+{
+	auto			csr = toCSR(makeRandomGraph(1000000, 8, 100));
+	PageRankOptions options;
+	options.tolerance = 1e-6;
+	for (size_t threads : { size_t(1), size_t(4) })
+	{
+		parallel::ThreadPool pool(threads);
+		std::cout << threads << " threads" << std::endl;
+		PageRank(csr, pool, options).printReport(std::cout);
+	}
+}
+
+void test_betweenness()
+{
+	// path 0 - 1 - 2 - 3 plus a bypass 0 - 4 - 2: node 2 carries everything towards 3
+	UGraph<int> ug;
+	for (auto [a, b] : std::vector<std::pair<int, int>> { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 0, 4 }, { 4, 2 } })
+	{
+		ug.addEdge(a, b);
+		ug.addEdge(b, a);
+	}
+	auto exact = Betweenness(ug, BetweennessOptions(), 2);
+	// pairs (both directions): 0-2 split over 1 and 4, 0-3 split too, 1-3 and 4-3 go via 2, 1-4 via 0 or 2
+	assert(std::abs(exact.getScore(1) - 2.0) < 1e-9 && std::abs(exact.getScore(4) - 2.0) < 1e-9);
+	assert(std::abs(exact.getScore(0) - 1.0) < 1e-9);
+	assert(std::abs(exact.getScore(2) - 7.0) < 1e-9);
+	assert(exact.getScore(3) == 0);
+
+	// weighted: the bypass is cheaper, so it takes node 1's share (1 <-> 4 ties between 0 and 2)
+	WGraph<unsigned int, int> wg;
+	for (auto [a, b, w] : std::vector<std::tuple<int, int, unsigned>> { { 0, 1, 2 }, { 1, 2, 2 }, { 2, 3, 1 }, { 0, 4, 1 }, { 4, 2, 1 } })
+	{
+		wg.addEdge(a, b, w);
+		wg.addEdge(b, a, w);
+	}
+	auto weighted = Betweenness(wg);
+	assert(weighted.getScore(1) == 0 && std::abs(weighted.getScore(4) - 4.0) < 1e-9);
+	assert(std::abs(weighted.getScore(0) - 1.0) < 1e-9);
+
+	// brute force over a random directed graph: count shortest paths through each node
+	auto g = makeRandomGraph(60, 2, 5);
+	auto csr = toCSR(g);
+	size_t n = csr.getNodesCount();
+	std::vector<std::vector<unsigned>> dist(n);
+	std::vector<std::vector<double>>   paths(n, std::vector<double>(n, 0.0));
+	for (uint32_t s = 0; s < n; ++s)
+	{
+		dist[s] = DijkstraDistances(s, csr);
+		std::vector<uint32_t> order(n);
+		std::iota(order.begin(), order.end(), 0u);
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dist[s][a] < dist[s][b]; });
+		paths[s][s] = 1;
+		for (uint32_t u : order)
+		{
+			if (dist[s][u] == std::numeric_limits<unsigned>::max())
+			{
+				break;
+			}
+			csr.forEachNeighbour(u, [&](uint32_t v, unsigned w) {
+				if (dist[s][u] + w == dist[s][v])
+				{
+					paths[s][v] += paths[s][u];
+				}
+			});
+		}
+	}
+	parallel::ThreadPool pool(3);
+	auto				 scores = Betweenness(csr, pool);
+	for (uint32_t v = 0; v < n; ++v)
+	{
+		double expected = 0;
+		for (uint32_t s = 0; s < n; ++s)
+		{
+			for (uint32_t t = 0; t < n; ++t)
+			{
+				if (s != v && t != v && s != t && paths[s][t] > 0 && dist[s][v] + dist[v][t] == dist[s][t])
+				{
+					expected += paths[s][v] * paths[v][t] / paths[s][t];
+				}
+			}
+		}
+		assert(std::abs(scores.scores[v] - expected) < 1e-6 * (1 + expected));
+	}
+
+	// sampling every node is exact, fewer sources scale up
+	BetweennessOptions sampled;
+	sampled.samples = n;
+	auto all_sampled = Betweenness(csr, pool, sampled);
+	for (uint32_t v = 0; v < n; ++v)
+	{
+		// per-worker partial sums are merged in whatever order the chunks were handed out
+		assert(std::abs(all_sampled.scores[v] - scores.scores[v]) < 1e-6 * (1 + scores.scores[v]));
+	}
+	sampled.samples = n / 2;
+	auto   estimate = Betweenness(csr, pool, sampled);
+	double total = std::accumulate(scores.scores.begin(), scores.scores.end(), 0.0);
+	double estimated = std::accumulate(estimate.scores.begin(), estimate.scores.end(), 0.0);
+	assert(estimated > 0.5 * total && estimated < 1.5 * total);
+
+	std::cout << "Betweenness tests passed!" << std::endl;
+}
+
+void test_max_flow()
+{
+	// CLRS figure 26.1: maximum flow 23
+	WGraph<unsigned int, int> clrs;
+	clrs.addEdge(0, 1, 16);
+	clrs.addEdge(0, 2, 13);
+	clrs.addEdge(2, 1, 4);
+	clrs.addEdge(1, 3, 12);
+	clrs.addEdge(3, 2, 9);
+	clrs.addEdge(2, 4, 14);
+	clrs.addEdge(4, 3, 7);
+	clrs.addEdge(3, 5, 20);
+	clrs.addEdge(4, 5, 4);
+	for (auto algorithm : { FlowAlgorithm::Dinic, FlowAlgorithm::PushRelabel, FlowAlgorithm::ParallelPushRelabel })
+	{
+		auto flow = MaxFlow(clrs, 0, 5, algorithm, 2);
+		assert(flow.value == 23);
+		assert(flow.isOnSourceSide(0) && flow.isOnSourceSide(2) && flow.isOnSourceSide(4));
+		assert(!flow.isOnSourceSide(3) && !flow.isOnSourceSide(5));
+		unsigned int cut = 0;
+		for (auto& edge : flow.cut_edges)
+		{
+			cut += edge.capacity;
+		}
+		assert(cut == 23);
+	}
+
+	// random networks: all algorithms agree, Dinic's flow is conserved and the cut is tight
+	parallel::ThreadPool pool(3);
+	for (unsigned seed = 1; seed <= 20; ++seed)
+	{
+		auto csr = toCSR(makeRandomGraph(300, 4, 50, seed));
+		int	 source = csr.ids[0], sink = csr.ids[csr.getNodesCount() - 1];
+
+		FlowNetwork<unsigned int> net = buildFlowNetwork(csr);
+		unsigned int			  value = Dinic(net, 0, uint32_t(csr.getNodesCount() - 1));
+		for (uint32_t u = 1; u + 1 < net.getNodesCount(); ++u)
+		{
+			long long balance = 0;
+			for (size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a)
+			{
+				balance += net.getFlow(a);
+				balance -= net.getFlow(net.reverse[a]);
+			}
+			assert(balance == 0);
+		}
+
+		std::vector<FlowResult<unsigned int, int>> results;
+		for (auto algorithm : { FlowAlgorithm::Dinic, FlowAlgorithm::PushRelabel, FlowAlgorithm::ParallelPushRelabel })
+		{
+			results.push_back(MaxFlow(csr, source, sink, algorithm, pool));
+			assert(results.back().value == value);
+			assert(results.back().source_side == results.front().source_side);
+		}
+		unsigned int cut = 0;
+		for (auto& edge : results.front().cut_edges)
+		{
+			cut += edge.capacity;
+		}
+		assert(cut == value);
+	}
+
+	std::cout << "Max-flow tests passed!" << std::endl;
+}
+
+void bench_max_flow()
+{
+	auto csr = toCSR(makeRandomGraph(200000, 6, 1000));
+	int	 source = csr.ids[0], sink = csr.ids[csr.getNodesCount() / 2];
+	for (auto [name, algorithm] : std::vector<std::pair<const char*, FlowAlgorithm>> {
+			 { "Dinic", FlowAlgorithm::Dinic }, { "push-relabel", FlowAlgorithm::PushRelabel }, { "parallel push-relabel", FlowAlgorithm::ParallelPushRelabel } })
+	{
+		parallel::ThreadPool pool(4);
+		auto				 start = std::chrono::steady_clock::now();
+		auto				 flow = MaxFlow(csr, source, sink, algorithm, pool);
+		auto				 ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		std::cout << name << ": flow " << flow.value << " in " << ms << " ms" << std::endl;
+	}
+}
+
+// Random obstacles with the given density, costs 1..max_cost elsewhere
+GridGraph makeRandomGrid(uint32_t side, double density, uint8_t max_cost, GridConnectivity connectivity, unsigned int seed = 42)
+{
+	std::mt19937						   rng(seed);
+	std::uniform_real_distribution<double> obstacle(0.0, 1.0);
+	std::uniform_int_distribution<int>	   cost(1, max_cost);
+	std::vector<uint8_t>				   cells(size_t(side) * side);
+	for (auto& cell : cells)
+	{
+		cell = obstacle(rng) < density ? GridGraph::blocked : uint8_t(cost(rng));
+	}
+	return GridGraph(side, side, std::move(cells), connectivity);
+}
+
+void test_grid_graph()
+{
+	auto is_valid = [](const GridGraph& grid, const std::vector<uint32_t>& path) {
+		for (size_t i = 1; i < path.size(); ++i)
+		{
+			bool adjacent = false;
+			grid.forEachNeighbour(path[i - 1], [&](uint32_t v, double) { adjacent |= v == path[i]; });
+			if (!adjacent)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	TraversalWorkspace<double> ws, reference;
+	for (auto connectivity : { GridConnectivity::Four, GridConnectivity::Eight })
+	{
+		for (uint8_t max_cost : { uint8_t(1), uint8_t(9) })
+		{
+			GridGraph grid = makeRandomGrid(120, 0.25, max_cost, connectivity);
+			assert(grid.getBytesCount() == 120 * 120);
+			std::mt19937							rng(1);
+			std::uniform_int_distribution<uint32_t> cell(0, 120 * 120 - 1);
+			for (int i = 0; i < 40; ++i)
+			{
+				uint32_t from = cell(rng), to = cell(rng);
+				auto	 [fx, fy] = grid.getCell(from);
+				auto	 [tx, ty] = grid.getCell(to);
+				if (!grid.isPassable(fx, fy) || !grid.isPassable(tx, ty))
+				{
+					continue;
+				}
+				DijkstraSearch(from, grid, reference, to);
+				double expected = reference.getDist(to);
+
+				for (bool jps : { false, true })
+				{
+					auto [path, cost] = findPath(from, to, grid, ws, jps);
+					if (expected == std::numeric_limits<double>::max())
+					{
+						assert(path.empty() && cost == expected);
+						continue;
+					}
+					assert(std::abs(cost - expected) < 1e-6);
+					assert(path.front() == from && path.back() == to && is_valid(grid, path));
+				}
+			}
+		}
+	}
+
+	GridGraph walled(5, 5, GridConnectivity::Eight);
+	for (uint32_t y = 0; y < 5; ++y)
+	{
+		walled.setCost(2, y, GridGraph::blocked);
+	}
+	assert(findPath(walled.getIndex(0, 0), walled.getIndex(4, 4), walled, true).first.empty());
+	walled.setCost(2, 4, 1);
+	auto detour = findPath(walled.getIndex(0, 0), walled.getIndex(4, 0), walled, true);
+	assert(detour.first.size() == 11 && std::abs(detour.second - (8 + 2 * std::sqrt(2.0))) < 1e-9); // no cutting past the wall end
+
+	std::cout << "Grid graph tests passed!" << std::endl;
+}
+
+void bench_grid_graph()
+{
+	GridGraph						   grid = makeRandomGrid(2000, 0.2, 1, GridConnectivity::Eight);
+	TraversalWorkspace<double>		   ws(grid.getNodesCount());
+	std::uniform_int_distribution<int> offset(0, 199);
+	for (bool jps : { false, true })
+	{
+		std::mt19937 rng(3);
+		auto		 start = std::chrono::steady_clock::now();
+		double total = 0;
+		for (int i = 0; i < 20; ++i)
+		{
+			auto [path, cost] = findPath(grid.getIndex(offset(rng), offset(rng)), grid.getIndex(1800 + offset(rng), 1800 + offset(rng)), grid, ws, jps);
+			total += path.empty() ? 0 : cost;
+		}
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		std::cout << (jps ? "jump-point search: " : "A*: ") << ms << " ms for 20 queries (" << total << "), " << grid.getBytesCount() << " bytes of grid" << std::endl;
+	}
+}
+
+void test_versioned_graph()
+{
+	auto							  initial = makeRandomGraph(500, 2, 100);
+	VersionedGraph<unsigned int, int> graph(initial, 300);
+	auto							  first = graph.getSnapshot();
+	assert(first->version == 0 && first->getEdgesCount() == initial.edges_to.size());
+
+	// every published version holds exactly the batches before it, and costs only shrink
+	constexpr int	  batches = 40, batch_size = 25;
+	std::atomic<bool> writing(true);
+	std::thread		  writer([&] {
+		std::mt19937					   rng(17);
+		std::uniform_int_distribution<int> node(0, 599);
+		for (int b = 0; b < batches; ++b)
+		{
+			for (int i = 0; i < batch_size; ++i)
+			{
+				int from = node(rng), to = node(rng);
+				graph.addEdge(from, to, 1 + node(rng) % 50);
+			}
+			graph.publish();
+		}
+		writing = false;
+	});
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 3; ++r)
+	{
+		readers.emplace_back([&, r] {
+			TraversalWorkspace<> ws;
+			uint64_t			 last_version = 0;
+			unsigned int		 last_cost = std::numeric_limits<unsigned int>::max();
+			while (writing)
+			{
+				auto snapshot = graph.getSnapshot();
+				assert(snapshot->version >= last_version);
+				assert(snapshot->getEdgesCount() == initial.edges_to.size() + snapshot->version * batch_size);
+				auto [path, cost] = findPath(r, 499 - r, *snapshot, ws);
+				assert(cost <= last_cost);
+				last_version = snapshot->version;
+				last_cost = cost;
+			}
+		});
+	}
+	writer.join();
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	// the old version is untouched, the last one matches a graph built with plain addEdge
+	assert(first->version == 0 && first->getEdgesCount() == initial.edges_to.size());
+	auto last = graph.getSnapshot();
+	assert(last->version == batches && last->getDeltaCount() < 300 && last->segments.size() <= 8);
+
+	auto							   rebuilt = initial;
+	std::mt19937					   rng(17);
+	std::uniform_int_distribution<int> node(0, 599);
+	for (int i = 0; i < batches * batch_size; ++i)
+	{
+		int from = node(rng), to = node(rng);
+		rebuilt.addEdge(from, to, 1 + node(rng) % 50);
+	}
+	for (int to : { 3, 250, 550, 599 })
+	{
+		if (rebuilt.nodes.count(to))
+		{
+			assert(findPath(0, to, *last).second == findPath(0, to, rebuilt).second);
+		}
+	}
+	assert(graph.publish() == batches);
+
+	std::cout << "Versioned graph tests passed!" << std::endl;
+}
+
+
+void test_lsm_graph()
+{
+	for (bool background : { false, true })
+	{
+		CompactionOptions options;
+		options.min_log_edges = 100;
+		options.max_log_edges = 400;
+		options.background = background;
+
+		auto							   reference = makeRandomGraph(300, 2, 100);
+		LSMGraph<unsigned int, int>		   graph(reference, options);
+		std::mt19937					   rng(23);
+		std::uniform_int_distribution<int> node(0, 399);
+		for (int i = 0; i < 3000; ++i)
+		{
+			int		 from = node(rng), to = node(rng);
+			unsigned weight = 1 + node(rng) % 100;
+			graph.addEdge(from, to, weight);
+			reference.addEdge(from, to, weight);
+
+			if (i % 500 == 499)
+			{
+				// every layer is visible: same node set, edge count and distances as the reference
+				assert(graph.getNodesCount() == reference.getNodesCount() && graph.getEdgesCount() == reference.edges_to.size());
+				auto costs = Dijkstra(0, reference);
+				auto dist = DijkstraDistances(graph.getIndex(0), graph);
+				for (auto& [v, cost] : costs)
+				{
+					assert(dist[graph.getIndex(v)] == cost);
+				}
+			}
+		}
+		graph.waitForCompaction();
+		assert(graph.getCompactionsCount() > 0);
+
+		graph.compact();
+		assert(graph.getLogEdgesCount() == 0 && graph.getEdgesCount() == reference.edges_to.size());
+		size_t degree = 0;
+		graph.forEachNeighbour(graph.getIndex(7), [&](uint32_t, unsigned) { ++degree; });
+		assert(degree == reference.edges_to.count(7));
+	}
+
+	std::cout << "LSM graph tests passed!" << std::endl;
+}
+
+void bench_lsm_graph()
+{
+	LSMGraph<unsigned int, int>		   graph;
+	WGraph<unsigned int, int>		   hashed;
+	std::mt19937					   rng(29);
+	std::uniform_int_distribution<int> node(0, 199999);
+	std::vector<std::pair<int, int>>   edges;
+	for (int i = 0; i < 1000000; ++i)
+	{
+		edges.emplace_back(node(rng), node(rng));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto [from, to] : edges)
+	{
+		graph.addEdge(from, to, 1);
+	}
+	graph.waitForCompaction();
+	auto lsm_insert = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (auto [from, to] : edges)
+	{
+		hashed.addEdge(from, to, 1);
+	}
+	auto hashed_insert = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	auto hops = BFSDistances(graph.getIndex(edges[0].first), graph);
+	auto lsm_bfs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	auto tree = Dijkstra(edges[0].first, hashed);
+	auto hashed_dijkstra = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "insert 1M edges: LSM " << lsm_insert << " ms (" << graph.getCompactionsCount() << " compactions), WGraph " << hashed_insert << " ms" << std::endl;
+	std::cout << "full traversal: LSM BFS " << lsm_bfs << " ms, WGraph Dijkstra " << hashed_dijkstra << " ms (" << hops.size() << ", " << tree.size() << ")" << std::endl;
+}
+
+void test_edge_relaxation()
+{
+	// int32 with negative weights: every kernel agrees with the reference Bellman-Ford
+	WGraph<int, int> dag;
+	for (int i = 0; i < 300; ++i)
+	{
+		dag.addEdge(i, i + 1, (i % 5) - 2);
+		dag.addEdge(i, i + 3, (i % 7) - 1);
+		dag.addEdge(i, i + 3, (i % 7) - 2); // parallel edges land in the same vector
+	}
+	dag.addEdge(1000, 1001, -1);
+	auto expected = Bellman_Ford<int, int>(0, dag);
+	assert(VectorBellmanFord(0, dag) == expected);
+	assert(EdgeCentricSSSP(0, dag, 1) == expected);
+	assert(EdgeCentricSSSP(0, dag, 4) == expected);
+
+	// uint32: duplicate targets inside one group of eight must keep the smallest candidate
+	WGraph<unsigned int, int> star;
+	for (unsigned int i = 0; i < 16; ++i)
+	{
+		star.addEdge(0, 1, 20 - i);
+	}
+	star.addEdge(1, 2, 1);
+	assert(VectorBellmanFord(0, star).at(2) == 6);
+
+	auto random = makeRandomGraph(2000, 4, 100);
+	auto costs = Dijkstra<unsigned int, int>(0, random);
+	auto hops = VectorBellmanFord(0, random);
+	assert(EdgeCentricSSSP(0, random, 3) == hops);
+	for (auto& [v, cost] : hops)
+	{
+		assert(cost == costs.at(v));
+	}
+
+	// float: integral weights keep the sums exact
+	WGraph<float, int> real;
+	for (auto& [from, edge] : random.edges_to)
+	{
+		real.addEdge(from, edge.second, float(edge.first));
+	}
+	auto real_costs = VectorBellmanFord(0, real);
+	assert(EdgeCentricSSSP(0, real, 2) == real_costs);
+	for (auto& [v, cost] : hops)
+	{
+		assert(cost == std::numeric_limits<unsigned int>::max() ? real_costs.at(v) == std::numeric_limits<float>::max() : real_costs.at(v) == float(cost));
+	}
+
+	WGraph<int, int> cycle;
+	cycle.addEdge(0, 1, 1);
+	cycle.addEdge(1, 2, -3);
+	cycle.addEdge(2, 1, 1);
+	for (int variant = 0; variant < 2; ++variant)
+	{
+		bool thrown = false;
+		try
+		{
+			variant == 0 ? VectorBellmanFord(0, cycle) : EdgeCentricSSSP(0, cycle, 2);
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	std::cout << "Edge relaxation tests passed! (" << (has_vector_relaxation<int> ? "AVX2" : "scalar") << " kernel)" << std::endl;
+}
+
+void bench_edge_relaxation()
+{
+	auto g = makeRandomGraph(1000000, 8, 1000);
+	auto edges = toEdgeList(toCSR(g));
+	std::cout << "vector kernel: " << (has_vector_relaxation<unsigned int> ? "yes" : "no") << std::endl;
+
+	// first passes improve many lanes, later ones almost none; time both kinds
+	std::vector<unsigned int> scalar(edges.getNodesCount(), std::numeric_limits<unsigned int>::max());
+	std::vector<unsigned int> vector = scalar;
+	scalar[edges.index.at(0)] = vector[edges.index.at(0)] = 0;
+	double scalar_ms = 0, vector_ms = 0;
+	size_t passes = 0;
+	for (bool changed = true; changed; ++passes)
+	{
+		auto start = std::chrono::steady_clock::now();
+		changed = detail::relaxEdgesScalar(edges.sources.data(), edges.targets.data(), edges.weights.data(), edges.getEdgesCount(), scalar.data(), scalar.data());
+		scalar_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		start = std::chrono::steady_clock::now();
+		RelaxEdges(edges, vector);
+		vector_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	assert(scalar == vector);
+	double gigabytes = double(passes) * edges.getEdgesCount() * 4 * sizeof(uint32_t) / 1e9;
+	std::cout << passes << " passes over " << edges.getEdgesCount() << " edges: scalar " << scalar_ms << " ms, vector " << vector_ms << " ms (" << gigabytes / (vector_ms / 1000) << " GB/s touched)" << std::endl;
+
+	auto start = std::chrono::steady_clock::now();
+	parallel::ThreadPool pool(0);
+	auto res = EdgeCentricSSSP(edges.index.at(0), edges, pool);
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	assert(res == vector);
+	std::cout << "EdgeCentricSSSP threads=" << pool.getThreadsCount() << ": " << elapsed << " ms" << std::endl;
+}